@@ -0,0 +1,136 @@
+"""
+Process-wide pool of read buffers under one memory ceiling.
+
+Every file hash takes its read buffer (or, for the shared-memory ring, the
+ring's size) from the same pool, so buffer memory stays under the ceiling
+however many files are hashed at once. A job that finds the pool exhausted
+waits for another to give memory back (back-pressure) instead of allocating
+more. Returned buffers are kept for reuse and count against the ceiling
+until a request of another size needs the room.
+
+The ceiling is DEFAULT_MEMORY_LIMIT unless HASH_MEMORY_LIMIT is set (bytes,
+or with a K, M or G suffix).
+"""
+
+import os
+import threading
+from typing import Callable, Dict, List, Optional
+
+DEFAULT_MEMORY_LIMIT = 256 * 1024 * 1024
+MIN_BUFFER_SIZE = 1024 * 1024  # Smallest share per job; smaller reads cost more than they save
+
+
+def parse_size(text: str) -> int:
+    """'512M' -> 536870912; plain numbers are bytes."""
+    text = text.strip().upper()
+    factor = {'K': 1 << 10, 'M': 1 << 20, 'G': 1 << 30}.get(text[-1:], 1)
+    if factor > 1:
+        text = text[:-1]
+    return int(text) * factor
+
+
+class BufferPool:
+    """Buffers and byte reservations drawn from a fixed memory budget."""
+
+    def __init__(self, limit: int):
+        self.limit = limit
+        self._allocated = 0  # In use plus kept for reuse
+        self._peak = 0
+        self._free: Dict[int, List[bytearray]] = {}
+        self._condition = threading.Condition()
+        self._generation = 0  # Bumped by wake()
+
+    @property
+    def peak(self) -> int:
+        """Most bytes allocated at once."""
+        return self._peak
+
+    def buffer_size(self, jobs: int, preferred: int) -> int:
+        """Per-job buffer size that lets `jobs` concurrent jobs fit the ceiling."""
+        share = self.limit // max(1, jobs)
+        return max(1, min(preferred, max(MIN_BUFFER_SIZE, share), self.limit))
+
+    def acquire(self, size: int, check_cancel: Callable[[], bool]) -> Optional[bytearray]:
+        """
+        A bytearray of `size` bytes (at most the ceiling), waiting while the
+        pool is exhausted. None if cancelled while waiting. Give it back with
+        release().
+        """
+        return self._take(size, check_cancel, keep=True)
+
+    def release(self, buffer: bytearray) -> None:
+        self._give(len(buffer), buffer)
+
+    def reserve(self, size: int, check_cancel: Callable[[], bool]) -> bool:
+        """
+        Count memory allocated elsewhere (a ring mapping) against the ceiling
+        until unreserve(). False if cancelled while waiting.
+        """
+        return self._take(size, check_cancel, keep=False) is not None
+
+    def unreserve(self, size: int) -> None:
+        self._give(size, None)
+
+    def trim(self) -> None:
+        """Free the buffers kept for reuse."""
+        with self._condition:
+            while self._drop_one():
+                pass
+            self._condition.notify_all()
+
+    def wake(self) -> None:
+        """Make every waiter re-check its cancel callback."""
+        with self._condition:
+            self._generation += 1
+            self._condition.notify_all()
+
+    def _take(self, size: int, check_cancel: Callable[[], bool], keep: bool) -> Optional[bytearray]:
+        size = min(size, self.limit)
+        with self._condition:
+            while True:
+                if keep and self._free.get(size):
+                    return self._free[size].pop()
+                if self._allocated + size <= self.limit:
+                    break
+                # Drop kept buffers of other sizes before waiting for returns
+                if self._drop_one():
+                    continue
+                if check_cancel():
+                    return None
+                generation = self._generation
+                self._condition.wait_for(
+                    lambda: self._allocated + size <= self.limit or self._generation != generation
+                    or any(self._free.values()))
+            self._allocated += size
+            self._peak = max(self._peak, self._allocated)
+        return bytearray(size) if keep else bytearray()
+
+    def _give(self, size: int, buffer: Optional[bytearray]) -> None:
+        size = min(size, self.limit)
+        with self._condition:
+            if buffer is not None:
+                self._free.setdefault(size, []).append(buffer)
+            else:
+                self._allocated -= size
+            self._condition.notify_all()
+
+    def _drop_one(self) -> bool:
+        for size, buffers in self._free.items():
+            if buffers:
+                buffers.pop()
+                self._allocated -= size
+                return True
+        return False
+
+
+def _configured_limit() -> int:
+    override = os.environ.get('HASH_MEMORY_LIMIT')
+    if override:
+        try:
+            return max(MIN_BUFFER_SIZE, parse_size(override))
+        except ValueError:
+            pass
+    return DEFAULT_MEMORY_LIMIT
+
+
+shared_pool = BufferPool(_configured_limit())
@@ -17,7 +17,7 @@ class StatusIndicator(tk.Frame):
         self.canvas.pack(side=tk.LEFT, padx=(0, 5))
         
         # Status text
-        self.label = ttk.Label(self, text="", width=35, anchor="w")
+        self.label = ttk.Label(self, text="", width=50, anchor="w")
         self.label.pack(side=tk.LEFT)
         
         self._angle = 0
@@ -27,13 +27,22 @@ class StatusIndicator(tk.Frame):
         # Initial state
         self.set_complete()
         
-    def set_calculating(self, progress: Optional[int] = None, prefix: str = ""):
-        """Set status to calculating with a spinner and optional progress."""
+    def set_calculating(self, progress: Optional[int] = None, prefix: str = "", detail: str = ""):
+        """Set status to calculating with a spinner, optional progress and detail (throughput/ETA)."""
         self._animating = True
+        text = f"{prefix}Calculating..."
         if progress is not None:
-            self.label.config(text=f"{prefix}Calculating... {progress}%")
-        else:
-            self.label.config(text=f"{prefix}Calculating...")
+            text += f" {progress}%"
+        if detail:
+            text += f" {detail}"
+        self.label.config(text=text)
+        if not self._animation_id:
+            self._animate_spinner()
+        
+    def set_busy(self, text: str):
+        """Set status to a spinner with the given text (work other than hashing)."""
+        self._animating = True
+        self.label.config(text=text)
         if not self._animation_id:
             self._animate_spinner()
         
@@ -33,12 +33,13 @@ class SecureHashGUI:
         self._calculation_thread: Optional[threading.Thread] = None
         self._cancel_flag = False
         self._debounce_timer = None
+        self._calibration_thread: Optional[threading.Thread] = None
         
         # Initialize logic engine
         self.hasher = HashCalculator()
         
-        # Calculate thread count: 20% of CPU cores, minimum 1
-        self._thread_count = max(1, int(multiprocessing.cpu_count() * 0.2))
+        # Thread count: calibrated for this host, else 20% of CPU cores, minimum 1
+        self._thread_count = self.hasher.tuned_thread_count() or max(1, int(multiprocessing.cpu_count() * 0.2))
         
         # Auto-calculate toggle variable
         self.auto_calc_var = tk.BooleanVar(value=False)
@@ -86,6 +87,11 @@ class SecureHashGUI:
             var = tk.BooleanVar(value=(algo == algorithms[0])) # Default first one selected
             self.hash_menu.add_checkbutton(label=algo, variable=var, command=self._on_input_change)
             self.algo_vars[algo] = var
+        
+        # Tools Menu: host calibration only runs when asked for
+        self.tools_menu = tk.Menu(self.menu_bar, tearoff=0)
+        self.menu_bar.add_cascade(label="Tools", menu=self.tools_menu)
+        self.tools_menu.add_command(label="Calibrate for This Host", command=self._calibrate)
             
         # Top row: Mode selection (Algorithm dropdown removed)
         top_frame = ttk.Frame(self.root)
@@ -335,61 +341,48 @@ class SecureHashGUI:
             # File mode - use background thread
             if self._calculation_thread and self._calculation_thread.is_alive():
                 return  # Already calculating
+            if self._calibration_thread and self._calibration_thread.is_alive():
+                messagebox.showwarning("Warning", "Calibration is running; try again when it is done.")
+                return
             
             self._cancel_flag = False
             self.status_indicator.set_calculating(0)
             self._set_result("") # Clear previous results
             
+            total_files = len(self.selected_file_paths)
+            file_paths = list(self.selected_file_paths)
+            
             # Define callbacks for the thread
-            def progress_cb(p):
-                # We'll update this to show overall progress or current file progress
-                self.root.after(0, self.status_indicator.set_calculating, p)
+            def progress_cb(files_done, p):
+                # Aggregated over all files; several are hashed at once
+                prefix = f"{files_done}/{total_files} "
+                self.root.after(0, self.status_indicator.set_calculating, p.percent, prefix, p.summary())
                 
             def check_cancel_cb():
                 return self._cancel_flag
                 
-            def error_cb(msg):
-                self.root.after(0, lambda: messagebox.showerror("Error", msg))
+            def error_cb(file_path, msg):
+                self.root.after(0, lambda: messagebox.showerror("Error", f"{file_path}: {msg}"))
                 
-            def success_cb(res):
-                # This is called per file, we need to append result
-                pass 
+            def success_cb(file_path, results_dict):
+                # Called once per file, in list order
+                result_str = f"{file_path}:\n"
+                for algo, hash_val in results_dict.items():
+                    result_str += f"{algo}: {hash_val}\n"
+                result_str += "\n"
+                self.root.after(0, self._append_result, result_str)
             
-            # Wrapper to process all files
+            # Wrapper to process all files on a pool of _thread_count workers
             def process_files():
-                total_files = len(self.selected_file_paths)
-                
-                for i, file_path in enumerate(self.selected_file_paths):
-                    if self._cancel_flag:
-                        break
-                        
-                    filename = os.path.basename(file_path)
-                    prefix = f"{i+1}/{total_files} "
-                    
-                    # Update status initially
-                    self.root.after(0, lambda p=prefix: self.status_indicator.set_calculating(None, p))
-                    
-                    # Local progress callback with prefix
-                    def file_progress_cb(p):
-                        self.root.after(0, lambda: self.status_indicator.set_calculating(p, prefix))
-                    
-                    # Local success callback to append result
-                    def file_success_cb(results_dict):
-                        result_str = f"{file_path}:\n"
-                        for algo, hash_val in results_dict.items():
-                            result_str += f"{algo}: {hash_val}\n"
-                        result_str += "\n"
-                        self.root.after(0, self._append_result, result_str)
-                    
-                    # Calculate hash for this file
-                    self.hasher.calculate_file(
-                        selected_algos, 
-                        file_path, 
-                        file_progress_cb, 
-                        check_cancel_cb, 
-                        error_cb, 
-                        file_success_cb
-                    )
+                self.hasher.calculate_files(
+                    selected_algos,
+                    file_paths,
+                    self._thread_count,
+                    progress_cb,
+                    check_cancel_cb,
+                    error_cb,
+                    success_cb
+                )
                 
                 self.root.after(0, self.status_indicator.set_complete)
 
@@ -418,6 +411,34 @@ class SecureHashGUI:
             finally:
                 self.status_indicator.set_complete()
     
+    def _calibrate(self) -> None:
+        """Run the host calibration in the background, with the CPU otherwise idle."""
+        if self._calibration_thread and self._calibration_thread.is_alive():
+            return
+        if self._calculation_thread and self._calculation_thread.is_alive():
+            messagebox.showwarning("Warning", "Calibration needs an idle CPU; wait for the files to finish.")
+            return
+        
+        self.tools_menu.entryconfig("Calibrate for This Host", state="disabled")
+        self.status_indicator.set_busy("Calibrating for this host (a few seconds)...")
+        
+        def finished(error: Optional[str]) -> None:
+            self.tools_menu.entryconfig("Calibrate for This Host", state="normal")
+            self.status_indicator.set_complete()
+            if error:
+                messagebox.showerror("Calibration Failed", error)
+                return
+            self._thread_count = self.hasher.tuned_thread_count() or self._thread_count
+            messagebox.showinfo("Calibration", f"Calibrated: {self._thread_count} worker threads, "
+                                f"{self.hasher.chunk_size // 1024} KiB buffers.")
+        
+        def run() -> None:
+            error = self.hasher.calibrate()
+            self.root.after(0, finished, error)
+        
+        self._calibration_thread = threading.Thread(target=run, daemon=True)
+        self._calibration_thread.start()
+    
     def _on_closing(self) -> None:
         """Handle window closing with proper cleanup."""
         # Set cancel flag
@@ -10,10 +10,150 @@ import hashlib
 import threading
 import queue
 import re
-from typing import Optional, Callable, Dict, Any
+import time
+from typing import Optional, Callable, Dict, Any, NamedTuple
 import tkinter as tk  # For messagebox if needed, though ideally we'd raise exceptions
 
+from buffer_pool import shared_pool
 from config import HashAlgorithm
+from shm_ring import RING_SUPPORTED, ShmRing
+
+try:
+    import _shahash  # In-process native kernels, built by setup.py (optional)
+except ImportError:
+    _shahash = None
+
+# Algorithms hashed in-process by _shahash instead of a subprocess
+NATIVE_ALGORITHMS = frozenset(_shahash.algorithms()) if _shahash else frozenset()
+
+DEFAULT_CHUNK_SIZE = 16 * 1024 * 1024  # 16MB, used until the host is calibrated
+PROGRESS_INTERVAL = 0.2  # Seconds between progress updates, as in src/common.h
+
+
+class Progress(NamedTuple):
+    """One progress record, as written by ProgressReporter in src/common.h."""
+    bytes_done: int
+    total_bytes: int         # 0 if the size is unknown
+    bytes_per_second: float  # Smoothed over recent intervals
+    eta_seconds: float       # -1 if unknown
+
+    @property
+    def percent(self) -> Optional[int]:
+        if self.total_bytes <= 0:
+            return None
+        return min(100, self.bytes_done * 100 // self.total_bytes)
+
+    def summary(self) -> str:
+        """Short throughput/ETA text, e.g. '412.3 MB/s, 0:42 left'."""
+        text = f"{self.bytes_per_second / (1024 * 1024):.1f} MB/s"
+        if self.eta_seconds >= 0:
+            minutes, seconds = divmod(int(self.eta_seconds + 0.5), 60)
+            text += f", {minutes}:{seconds:02d} left"
+        elif self.total_bytes <= 0:
+            text += f", {self.bytes_done / (1024 * 1024):.0f} MB"
+        return text
+
+
+def parse_progress_record(line: bytes) -> Optional[Progress]:
+    """Parse a 'PROGRESS <bytes> <total> <bytes_per_s> <eta_s>' stderr line."""
+    fields = line.split()
+    if len(fields) != 5 or fields[0] != b'PROGRESS':
+        return None
+    try:
+        return Progress(int(fields[1]), int(fields[2]), float(fields[3]), float(fields[4]))
+    except ValueError:
+        return None
+
+
+class ProgressMeter:
+    """
+    Python twin of ProgressReporter for hashing done in this process:
+    reports at most once per interval, plus a first and a final record.
+    """
+
+    def __init__(self, total_bytes: int, callback: Callable[[Progress], None],
+                 interval: float = PROGRESS_INTERVAL):
+        self._total = total_bytes
+        self._callback = callback
+        self._interval = interval
+        self._last_time = time.monotonic()
+        self._last_bytes = 0
+        self._rate = 0.0
+        self._emit(0, self._last_time)
+
+    def update(self, bytes_done: int) -> None:
+        now = time.monotonic()
+        if now - self._last_time >= self._interval:
+            self._emit(bytes_done, now)
+
+    def finish(self, bytes_done: int) -> None:
+        self._emit(bytes_done, time.monotonic())
+
+    def _emit(self, bytes_done: int, now: float) -> None:
+        window = now - self._last_time
+        if window > 0 and bytes_done > self._last_bytes:
+            window_rate = (bytes_done - self._last_bytes) / window
+            self._rate = 0.7 * self._rate + 0.3 * window_rate if self._rate > 0 else window_rate
+        eta = -1.0
+        if self._total > 0 and self._rate > 0:
+            eta = max(0.0, (self._total - bytes_done) / self._rate)
+        self._callback(Progress(bytes_done, self._total, self._rate, eta))
+        self._last_time = now
+        self._last_bytes = bytes_done
+
+
+def _bin_path(executable_name: str) -> str:
+    """Path of a native executable (works for both dev and PyInstaller)."""
+    if getattr(sys, 'frozen', False):
+        base_path = sys._MEIPASS
+    else:
+        base_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+    return os.path.join(base_path, 'bin', executable_name)
+
+
+def tuning_profile_path() -> str:
+    """
+    Per-host profile written by `HashEngine --tune`.
+    Mirrors tuningProfilePath() in src/tuning.h.
+    """
+    override = os.environ.get('HASH_TUNE_FILE')
+    if override:
+        return override
+    if sys.platform == 'win32':
+        host = os.environ.get('COMPUTERNAME', '')
+        directory = os.path.join(os.environ.get('LOCALAPPDATA', '.'), 'HashingAlgorithm')
+    else:
+        host = os.uname().nodename
+        cache_home = os.environ.get('XDG_CACHE_HOME') or os.path.join(os.environ.get('HOME', '.'), '.cache')
+        directory = os.path.join(cache_home, 'hashing-algorithm')
+    host = re.sub(r'[^A-Za-z0-9._-]', '_', host) or 'localhost'
+    return os.path.join(directory, f'profile-{host}.txt')
+
+
+def load_tuning_profile() -> Dict[str, Any]:
+    """
+    Read the tuning profile.
+    
+    Returns:
+        {'buffer_size': int, 'threads': int, 'kernels': {family: variant}},
+        or an empty dict if the host has not been calibrated yet
+    """
+    profile: Dict[str, Any] = {}
+    try:
+        with open(tuning_profile_path(), 'r') as f:
+            for line in f:
+                key, _, value = line.strip().partition(' ')
+                if key == 'buffer_size' and value.isdigit():
+                    profile['buffer_size'] = int(value)
+                elif key == 'threads' and value.isdigit():
+                    profile['threads'] = int(value)
+                elif key == 'kernel':
+                    family, _, variant = value.rpartition(' ')
+                    profile.setdefault('kernels', {})[family] = variant
+    except OSError:
+        return {}
+    return profile
+
 
 class HashCalculator:
     """Handles hash calculations."""
@@ -21,12 +161,53 @@ class HashCalculator:
     _subprocess_warmed_up = False  # Class variable to track warmup
     
     def __init__(self):
-        self._current_process: Optional[subprocess.Popen] = None
+        # Running subprocesses (several when files are hashed in parallel),
+        # each with the event queue its waiter blocks on
+        self._processes: Dict[subprocess.Popen, queue.Queue] = {}
+        self._process_lock = threading.Lock()
+        self._profile = load_tuning_profile()
+        # Text mode: per-algorithm midstate caches, so re-hashing after an
+        # edit resumes from the first changed block instead of the start
+        self._text_caches: Dict[str, Any] = {}
         # Warm up subprocess system on first instantiation
         if not HashCalculator._subprocess_warmed_up:
             self._warmup_subprocess()
             HashCalculator._subprocess_warmed_up = True
     
+    def is_calibrated(self) -> bool:
+        """True once this host has a tuning profile."""
+        return bool(self._profile)
+    
+    def calibrate(self) -> Optional[str]:
+        """
+        Run `HashEngine --tune` and pick up the profile it writes. Blocks for
+        a few seconds with every core busy, so it only runs when asked for.
+        
+        Returns:
+            None on success, else an error message
+        """
+        engine_path = _bin_path('HashEngine.exe')
+        if not os.path.exists(engine_path):
+            return f"{engine_path} not found"
+        try:
+            result = subprocess.run([engine_path, '--tune'], capture_output=True, text=True, timeout=120,
+                                    creationflags=subprocess.CREATE_NO_WINDOW if hasattr(subprocess, 'CREATE_NO_WINDOW') else 0)
+        except (OSError, subprocess.SubprocessError) as e:
+            return str(e)
+        if result.returncode != 0:
+            return result.stderr.strip() or f"HashEngine --tune exited with code {result.returncode}"
+        self._profile = load_tuning_profile()
+        return None
+    
+    @property
+    def chunk_size(self) -> int:
+        """Read/stream chunk size: the calibrated buffer size, else 16MB."""
+        return self._profile.get('buffer_size') or DEFAULT_CHUNK_SIZE
+    
+    def tuned_thread_count(self) -> Optional[int]:
+        """Worker count the calibration found useful, or None if not calibrated."""
+        return self._profile.get('threads')
+    
     def _warmup_subprocess(self):
         """Warm up the subprocess system to prevent first-call delays."""
         try:
@@ -58,7 +239,12 @@ class HashCalculator:
                 
             algo_type = algo_config.get('type')
             
-            if algo_type == 'executable':
+            if algo_type == 'executable' and algo in NATIVE_ALGORITHMS:
+                cache = self._text_caches.get(algo)
+                if cache is None:
+                    cache = self._text_caches[algo] = _shahash.midstate_cache(algo)
+                results[algo] = cache.hexdigest(input_bytes)
+            elif algo_type == 'executable':
                 executable_name = algo_config.get('executable')
                 if not executable_name:
                     results[algo] = "Error: No executable specified"
@@ -105,21 +291,27 @@ class HashCalculator:
     def calculate_file(self, 
                       algorithms: list[str], 
                       file_path: str, 
-                      progress_callback: Callable[[int], None],
+                      progress_callback: Callable[[Progress], None],
                       check_cancel_callback: Callable[[], bool],
                       error_callback: Callable[[str], None],
-                      success_callback: Callable[[dict[str, str]], None]) -> None:
+                      success_callback: Callable[[dict[str, str]], None],
+                      chunk_size: Optional[int] = None) -> None:
         """
         Calculate multiple hashes for a file in a single pass.
         
         Args:
             algorithms: List of algorithm names
             file_path: Path to file
-            progress_callback: Function to call with progress percentage
+            progress_callback: Function to call with Progress records
             check_cancel_callback: Function that returns True if calculation should be cancelled
             error_callback: Function to call with error message
             success_callback: Function to call with result dictionary
+            chunk_size: Read buffer size, drawn from the shared buffer pool
+                (default: the tuned chunk size, capped by the pool ceiling)
         """
+        if chunk_size is None:
+            chunk_size = shared_pool.buffer_size(1, self.chunk_size)
+        
         # Map algorithm names to hashlib functions/constructors
         hashlib_map = {
             'SHA-256': hashlib.sha256,
@@ -127,25 +319,28 @@ class HashCalculator:
             'SHA-512': hashlib.sha512
         }
         
-        # Separate algorithms into fast (hashlib/zlib) and slow (subprocess)
+        # Separate algorithms into fast (hashlib/zlib, or the _shahash
+        # extension when it is built) and slow (subprocess)
         fast_algos = []
+        native_algos = []
         subprocess_algos = []
         
         for algo in algorithms:
             if algo in hashlib_map or algo == 'CRC-32':
                 fast_algos.append(algo)
+            elif algo in NATIVE_ALGORITHMS:
+                native_algos.append(algo)
             else:
                 subprocess_algos.append(algo)
         
         results = {}
         
         try:
-            # 1. Process all fast algorithms in ONE pass
-            if fast_algos:
+            # 1. Process all fast and native algorithms in ONE pass
+            if fast_algos or native_algos:
                 file_size = os.path.getsize(file_path)
-                CHUNK_SIZE = 16 * 1024 * 1024  # 16MB
                 bytes_processed = 0
-                last_progress = 0
+                meter = ProgressMeter(file_size, progress_callback)
                 
                 # Initialize hashers
                 hashers = {}
@@ -156,31 +351,43 @@ class HashCalculator:
                         crc_val = 0
                     else:
                         hashers[algo] = hashlib_map[algo]()
+                native_hashers = [_shahash.new(algo) for algo in native_algos]
                 
                 import zlib
                 
-                with open(file_path, 'rb') as f:
-                    while True:
-                        if check_cancel_callback():
-                            return
-                        
-                        chunk = f.read(CHUNK_SIZE)
-                        if not chunk:
-                            break
-                        
-                        # Update all hashers with the same chunk
-                        for algo in fast_algos:
-                            if algo == 'CRC-32':
-                                crc_val = zlib.crc32(chunk, crc_val)
-                            else:
-                                hashers[algo].update(chunk)
-                        
-                        bytes_processed += len(chunk)
-                        current_progress = int((bytes_processed / file_size) * 100)
-                        
-                        if current_progress >= last_progress + 5:
-                            progress_callback(current_progress)
-                            last_progress = current_progress
+                # One pooled buffer; every consumer takes the memoryview without copying
+                buffer = shared_pool.acquire(chunk_size, check_cancel_callback)
+                if buffer is None:
+                    return
+                view = memoryview(buffer)
+                
+                try:
+                    with open(file_path, 'rb') as f:
+                        while True:
+                            if check_cancel_callback():
+                                return
+                            
+                            length = f.readinto(buffer)
+                            if not length:
+                                break
+                            chunk = view[:length]
+                            
+                            # Update all hashers with the same chunk
+                            for algo in fast_algos:
+                                if algo == 'CRC-32':
+                                    crc_val = zlib.crc32(chunk, crc_val)
+                                else:
+                                    hashers[algo].update(chunk)
+                            if native_hashers:
+                                _shahash.update_all(native_hashers, chunk)
+                            
+                            bytes_processed += length
+                            meter.update(bytes_processed)
+                finally:
+                    view.release()
+                    shared_pool.release(buffer)
+                
+                meter.finish(bytes_processed)
                 
                 # Finalize results
                 for algo in fast_algos:
@@ -188,6 +395,8 @@ class HashCalculator:
                         results[algo] = format(crc_val & 0xFFFFFFFF, '08x')
                     else:
                         results[algo] = hashers[algo].hexdigest()
+                for hasher in native_hashers:
+                    results[hasher.name] = hasher.hexdigest()
 
             # 2. Process subprocess algorithms (sequentially, unfortunately)
             # Note: Running these in parallel with fast algos would be complex due to disk I/O contention
@@ -203,7 +412,8 @@ class HashCalculator:
                     file_path, 
                     progress_callback, # This might be jumpy if mixed with fast ones
                     check_cancel_callback, 
-                    lambda res: results.update({algo: res})
+                    lambda res: results.update({algo: res}),
+                    chunk_size
                 )
             
             success_callback(results)
@@ -211,12 +421,112 @@ class HashCalculator:
         except Exception as ex:
             error_callback(str(ex))
 
+    def calculate_files(self,
+                        algorithms: list[str],
+                        file_paths: list[str],
+                        thread_count: int,
+                        progress_callback: Callable[[int, Progress], None],
+                        check_cancel_callback: Callable[[], bool],
+                        error_callback: Callable[[str, str], None],
+                        success_callback: Callable[[str, dict[str, str]], None]) -> None:
+        """
+        Hash several files concurrently, each with calculate_file, on a pool of
+        thread_count worker threads. Blocks until every file is done or the run
+        is cancelled.
+        
+        Results are reported in list order whatever order the files finish in:
+        success_callback(path, results) or error_callback(path, message).
+        progress_callback(files_done, progress) covers the bytes of all files.
+        
+        Every worker reads through a buffer from the shared pool, sized so all
+        of them fit its ceiling; memory stays bounded for any thread_count.
+        """
+        count = len(file_paths)
+        sizes = []
+        for path in file_paths:
+            try:
+                sizes.append(os.path.getsize(path))
+            except OSError:
+                sizes.append(0)  # Reported as an error when its turn comes
+        
+        lock = threading.Lock()
+        file_bytes = [0] * count   # Bytes hashed per file
+        outcomes: Dict[int, tuple] = {}  # Finished files not yet reported
+        state = {'next_file': 0, 'next_report': 0, 'files_done': 0, 'bytes_done': 0}
+        meter = ProgressMeter(sum(sizes), lambda p: progress_callback(state['files_done'], p))
+        worker_count = max(1, min(thread_count, count))
+        chunk_size = shared_pool.buffer_size(worker_count, self.chunk_size)
+        
+        def file_progress(index: int, record: Progress) -> None:
+            with lock:
+                # Subprocess algorithms re-read the file, restarting at 0;
+                # keep the aggregate from moving backwards
+                done = min(record.bytes_done, sizes[index])
+                if done > file_bytes[index]:
+                    state['bytes_done'] += done - file_bytes[index]
+                    file_bytes[index] = done
+                    meter.update(state['bytes_done'])
+        
+        def file_finished(index: int, outcome: tuple) -> None:
+            with lock:
+                state['bytes_done'] += sizes[index] - file_bytes[index]
+                file_bytes[index] = sizes[index]
+                state['files_done'] += 1
+                meter.update(state['bytes_done'])
+                
+                # Report every result that is now next in list order; under the
+                # lock so two workers cannot interleave their reports
+                outcomes[index] = outcome
+                while state['next_report'] in outcomes:
+                    i = state['next_report']
+                    kind, payload = outcomes.pop(i)
+                    if kind == 'ok':
+                        success_callback(file_paths[i], payload)
+                    else:
+                        error_callback(file_paths[i], payload)
+                    state['next_report'] += 1
+        
+        def worker() -> None:
+            while not check_cancel_callback():
+                with lock:
+                    index = state['next_file']
+                    if index >= count:
+                        return
+                    state['next_file'] += 1
+                
+                outcome = []
+                self.calculate_file(
+                    algorithms,
+                    file_paths[index],
+                    lambda p, i=index: file_progress(i, p),
+                    check_cancel_callback,
+                    lambda message: outcome.append(('error', message)),
+                    lambda results: outcome.append(('ok', results)),
+                    chunk_size
+                )
+                if not outcome:  # Cancelled mid-file
+                    return
+                file_finished(index, outcome[0])
+        
+        workers = [threading.Thread(target=worker, daemon=True)
+                   for _ in range(worker_count)]
+        for thread in workers:
+            thread.start()
+        for thread in workers:
+            thread.join()
+        shared_pool.trim()
+        
+        if not check_cancel_callback():
+            with lock:
+                meter.finish(state['bytes_done'])
+
     def _calculate_file_subprocess(self, 
                                   algorithm: str, 
                                   file_path: str, 
-                                  progress_callback: Callable[[int], None],
+                                  progress_callback: Callable[[Progress], None],
                                   check_cancel_callback: Callable[[], bool],
-                                  success_callback: Callable[[str], None]) -> None:
+                                  success_callback: Callable[[str], None],
+                                  chunk_size: int) -> None:
         """Internal method for subprocess fallback."""
         algo_config = HashAlgorithm.get_algorithm_config(algorithm)
         
@@ -241,70 +551,147 @@ class HashCalculator:
         
         # Get file size
         file_size = os.path.getsize(file_path)
-
+        CHUNK_SIZE = chunk_size
+        
+        # On Linux the file is read straight into a shared-memory ring the
+        # hasher reads in place; elsewhere it is streamed through stdin from a
+        # pooled buffer. Either way CHUNK_SIZE bytes come out of the pool.
+        ring = None
+        buffer = None
+        
+        def release_memory():
+            if ring:
+                ring.close()
+                shared_pool.unreserve(CHUNK_SIZE)
+            if buffer is not None:
+                shared_pool.release(buffer)
+        
+        if RING_SUPPORTED:
+            if not shared_pool.reserve(CHUNK_SIZE, check_cancel_callback):
+                return
+            try:
+                ring = ShmRing(CHUNK_SIZE)
+            except OSError:
+                shared_pool.unreserve(CHUNK_SIZE)
+                ring = None
+        if not ring:
+            buffer = shared_pool.acquire(CHUNK_SIZE, check_cancel_callback)
+            if buffer is None:
+                return
+        
         # Launch C++ process
-        proc = subprocess.Popen(
-            [executable_path, str(file_size)],
-            stdin=subprocess.PIPE,
-            stdout=subprocess.PIPE,
-            stderr=subprocess.PIPE,
-            bufsize=0
-        )
+        args = [executable_path, str(file_size)]
+        if ring:
+            args += ['--ring', ring.spec()]
+        try:
+            proc = subprocess.Popen(
+                args,
+                stdin=subprocess.DEVNULL if ring else subprocess.PIPE,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.PIPE,
+                bufsize=0,
+                pass_fds=ring.fds() if ring else ()
+            )
+        except OSError:
+            release_memory()
+            raise
         
-        self._current_process = proc
+        # Everything the waiter reacts to arrives on one queue, so waiting is a
+        # blocking get() (no polling): progress records and end-of-stream from
+        # the reader threads, and a cancel event from terminate_subprocess().
+        # A queue rather than a self-pipe, so the same code works on Windows.
+        events: queue.Queue = queue.Queue()
+        with self._process_lock:
+            self._processes[proc] = events
+        
+        def read_stderr():
+            for line in iter(proc.stderr.readline, b''):
+                record = parse_progress_record(line)
+                if record is not None:
+                    events.put(('progress', record))
+            events.put(('stderr_closed', None))
+        
+        def read_stdout():
+            output = proc.stdout.read()
+            if ring:
+                ring.wake()  # The hasher has exited; unblock a producer waiting for space
+            events.put(('stdout', output))
+        
+        for reader in (read_stderr, read_stdout):
+            threading.Thread(target=reader, daemon=True).start()
+        
+        pending = []  # Non-progress events seen while streaming
+        
+        def drain_progress():
+            """Forward queued progress without blocking; False once cancelled."""
+            while True:
+                try:
+                    kind, payload = events.get_nowait()
+                except queue.Empty:
+                    return True
+                if kind == 'progress':
+                    progress_callback(payload)
+                elif kind == 'cancel':
+                    return False
+                else:
+                    pending.append((kind, payload))
         
         try:
-            CHUNK_SIZE = 16 * 1024 * 1024
-            
-            # Thread to read stderr for progress
-            progress_queue = queue.Queue()
-            
-            def read_stderr():
-                progress_pattern = re.compile(r'PROGRESS:(\d+)')
-                while True:
-                    line = proc.stderr.readline()
-                    if not line:
-                        break
-                    line_str = line.decode('utf-8', errors='ignore').strip()
-                    match = progress_pattern.match(line_str)
-                    if match:
-                        progress_queue.put(int(match.group(1)))
-            
-            stderr_thread = threading.Thread(target=read_stderr, daemon=True)
-            stderr_thread.start()
-            
-            # Stream file to stdin
+            # Stream the file; a full ring or pipe blocks the producer, not the CPU
             with open(file_path, 'rb') as f:
                 while True:
-                    if check_cancel_callback():
-                        proc.terminate()
-                        proc.wait()
+                    if check_cancel_callback() or not drain_progress():
                         return
                     
-                    chunk = f.read(CHUNK_SIZE)
-                    if not chunk:
-                        break
+                    if ring:
+                        # Quarter-ring spans, so the hasher works while the next one is read
+                        span = ring.reserve(CHUNK_SIZE // 4)
+                        if span is None:
+                            if check_cancel_callback():
+                                return
+                            raise RuntimeError("Hash calculation failed: the hasher exited early")
+                        length = f.readinto(span)
+                        span.release()
+                        if not length:
+                            break
+                        ring.commit(length)
+                        continue
                     
-                    proc.stdin.write(chunk)
+                    length = f.readinto(buffer)
+                    if not length:
+                        break
                     
-                    while not progress_queue.empty():
-                        progress_callback(progress_queue.get())
+                    try:
+                        with memoryview(buffer) as view:
+                            proc.stdin.write(view[:length])
+                    except (BrokenPipeError, OSError):
+                        if check_cancel_callback():
+                            return
+                        raise RuntimeError("Hash calculation failed: the hasher exited early")
             
-            proc.stdin.close()
+            if ring:
+                ring.finish()
+            else:
+                proc.stdin.close()
             
-            # Wait for completion
-            while True:
-                if check_cancel_callback():
-                    proc.terminate()
-                    proc.wait()
+            # Wait for both output streams to close
+            stdout = None
+            stderr_open = True
+            while stdout is None or stderr_open:
+                kind, payload = pending.pop(0) if pending else events.get()
+                if kind == 'progress':
+                    progress_callback(payload)
+                elif kind == 'stdout':
+                    stdout = payload
+                elif kind == 'stderr_closed':
+                    stderr_open = False
+                elif kind == 'cancel':
                     return
-                if proc.poll() is not None:
-                    break
-                while not progress_queue.empty():
-                    progress_callback(progress_queue.get())
-            
-            stdout, _ = proc.communicate()
             
+            # Both pipes are closed, so the process is exiting; wait() blocks in the kernel
+            proc.wait()
+            if check_cancel_callback():
+                return
             if proc.returncode != 0:
                 raise RuntimeError("Hash calculation failed")
             
@@ -313,14 +700,36 @@ class HashCalculator:
         finally:
             if proc.poll() is None:
                 proc.terminate()
+                # End the input too: a hasher that took the signal between its
+                # cancel check and its next read would otherwise wait for data
+                try:
+                    if ring:
+                        ring.finish()
+                    else:
+                        proc.stdin.close()
+                except OSError:
+                    pass
                 proc.wait()
-            self._current_process = None
+            release_memory()
+            with self._process_lock:
+                self._processes.pop(proc, None)
 
     def terminate_subprocess(self):
-        """Force terminate any running subprocess."""
-        if self._current_process and self._current_process.poll() is None:
-            self._current_process.terminate()
+        """
+        Stop every running subprocess and wake the threads waiting on them.
+        On POSIX terminate() is SIGTERM, which the hashers treat as a cancel:
+        they stop within one buffer and exit (src/cancel_token.h). kill() is
+        only the fallback for a hasher that does not exit in time.
+        """
+        with self._process_lock:
+            running = list(self._processes.items())
+        shared_pool.wake()  # Jobs waiting for buffer memory
+        for proc, events in running:
+            events.put(('cancel', None))
+            if proc.poll() is None:
+                proc.terminate()
+        for proc, _ in running:
             try:
-                self._current_process.wait(timeout=1.0)
+                proc.wait(timeout=1.0)
             except subprocess.TimeoutExpired:
-                self._current_process.kill()
+                proc.kill()
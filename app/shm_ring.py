@@ -0,0 +1,112 @@
+"""
+Producer side of the shared-memory input ring (see src/shm_ring.h).
+
+Input is written straight into a memfd mapping that the native hasher reads
+in place; two eventfd doorbells carry byte counts in each direction. Compared
+with streaming through stdin this saves the copy into the pipe and the copy
+out of it, and the 64 KiB pipe buffer no longer throttles the producer.
+
+Linux only (os.memfd_create, os.eventfd: Python 3.10+); callers fall back to
+a pipe when RING_SUPPORTED is False.
+"""
+
+import mmap
+import os
+import struct
+import threading
+from typing import Optional
+
+RING_SUPPORTED = hasattr(os, 'memfd_create') and hasattr(os, 'eventfd')
+
+RING_HEADER_SIZE = 64
+RING_MAGIC = b'HASHRNG1'
+RING_FLAG = 1 << 62  # End of input on the data doorbell, wake-up on the space doorbell
+
+
+class ShmRing:
+    """
+    Single-producer ring. Pass fds() to the child via Popen(pass_fds=...) and
+    "--ring <spec()>" on its command line, then either write(data) or fill
+    reserve()d views in place (e.g. file.readinto) and commit() them.
+    """
+
+    def __init__(self, capacity: int):
+        self.capacity = capacity
+        self._memory_fd = os.memfd_create('hash-ring')
+        self._data_fd = os.eventfd(0)
+        self._space_fd = os.eventfd(0)
+        os.ftruncate(self._memory_fd, RING_HEADER_SIZE + capacity)
+        self._map = mmap.mmap(self._memory_fd, RING_HEADER_SIZE + capacity)
+        self._map[:16] = struct.pack('<8sQ', RING_MAGIC, capacity)
+        self._view = memoryview(self._map)[RING_HEADER_SIZE:]
+        self._written = 0  # Bytes committed
+        self._freed = 0    # Bytes the hasher has released
+        self._finished = False
+        self._closed = False
+        self._close_lock = threading.Lock()  # wake() may race close() from another thread
+
+    def fds(self) -> tuple:
+        return (self._memory_fd, self._data_fd, self._space_fd)
+
+    def spec(self) -> str:
+        # The pid lets the hasher notice if this process dies mid-input
+        return f"{self._memory_fd}:{self._data_fd}:{self._space_fd}:{os.getpid()}"
+
+    def reserve(self, max_bytes: int) -> Optional[memoryview]:
+        """
+        Writable view of the next free span (at most max_bytes), blocking
+        until the hasher frees space. None if wake() interrupted the wait.
+        """
+        while self._written - self._freed == self.capacity:
+            value = os.eventfd_read(self._space_fd)
+            woken = value >= RING_FLAG
+            self._freed += value - RING_FLAG if woken else value
+            if woken:
+                return None
+        offset = self._written % self.capacity
+        free = self.capacity - (self._written - self._freed)
+        length = min(max_bytes, free, self.capacity - offset)
+        return self._view[offset:offset + length]
+
+    def commit(self, length: int) -> None:
+        """Publish length bytes written into the last reserve()d view."""
+        if length:
+            self._written += length
+            os.eventfd_write(self._data_fd, length)
+
+    def write(self, data) -> bool:
+        """Copy a bytes-like object into the ring; False if woken first."""
+        source = memoryview(data).cast('B')
+        while source:
+            span = self.reserve(len(source))
+            if span is None:
+                return False
+            length = len(span)
+            span[:] = source[:length]
+            span.release()
+            self.commit(length)
+            source = source[length:]
+        return True
+
+    def finish(self) -> None:
+        """Signal end of input; later calls do nothing."""
+        # A second flag would add to the first in the eventfd counter
+        if not self._finished:
+            self._finished = True
+            os.eventfd_write(self._data_fd, RING_FLAG)
+
+    def wake(self) -> None:
+        """Interrupt a producer blocked in reserve() (cancel, hasher exited)."""
+        with self._close_lock:
+            if not self._closed:
+                os.eventfd_write(self._space_fd, RING_FLAG)
+
+    def close(self) -> None:
+        with self._close_lock:
+            if self._closed:
+                return
+            self._closed = True
+            self._view.release()
+            self._map.close()
+            for fd in self.fds():
+                os.close(fd)
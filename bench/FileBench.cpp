@@ -0,0 +1,510 @@
+// End-to-end file hashing benchmark.
+// Generates synthetic files and hashes them through each input backend
+// (pipe, read, mmap, io_uring, O_DIRECT) across buffer sizes, thread counts
+// and warm/cold page cache, reporting wall time, CPU time and throughput as CSV.
+//
+// Usage: FileBench [--dir PATH] [--size 64M,1G] [--files N] [--algo NAME]
+//                  [--backends read,mmap,...] [--buffers 64K,1M,16M]
+//                  [--threads 1,2,4] [--cache warm,cold] [--keep] [--trace FILE]
+//                  [--metrics FILE]
+//
+// --trace records every file, buffer, read wait and pipe stall per worker
+// thread as Chrome Trace Event JSON (open in Perfetto). --metrics keeps a
+// live snapshot of files done/queued, throughput and backends in FILE.
+//
+// Read buffers come from the shared pool (buffer_pool.h), so all workers
+// together stay under HASH_MEMORY_LIMIT (default 256 MiB); workers past it
+// wait for a buffer, which shows up as lower throughput.
+//
+// Cold runs evict the files with posix_fadvise(DONTNEED) first; this is
+// best-effort and needs a disk-backed --dir (tmpfs cannot be evicted).
+//
+// Thread scaling: FileBench --scaling files|tree|crc [--max-threads T]
+//   files  --files N synthetic files hashed by 1..T workers
+//   tree   one --size file split into --leaf-size leaves hashed in parallel,
+//          root = hash of the concatenated leaf digests (not a plain digest)
+//   crc    one file, leaves CRC'd in parallel and joined with crc32Combine
+//          (identical to the sequential CRC-32)
+// Rows report throughput, speedup, per-thread efficiency and mark the knee:
+// the last thread count before an added thread yields less than half a
+// single thread's throughput.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#include "../src/buffer_pool.h"
+#include "../src/file_reader.h"
+#include "../src/common.h"
+#include "../src/hash_registry.h"
+#include "../src/trace.h"
+#include "../src/live_metrics.h"
+
+using namespace std;
+
+LiveMetrics metrics;   // Counters are published only once --metrics opens the file
+
+size_t parseSize(const string& text) {
+    size_t multiplier = 1;
+    string digits = text;
+    char suffix = digits.empty() ? 0 : toupper(digits.back());
+    if (suffix == 'K') multiplier = 1024;
+    if (suffix == 'M') multiplier = 1024 * 1024;
+    if (suffix == 'G') multiplier = 1024 * 1024 * 1024;
+    if (multiplier > 1) digits.pop_back();
+    return stoull(digits) * multiplier;
+}
+
+vector<string> splitList(const string& text) {
+    vector<string> items;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// User + system time of the whole process (includes pipe writer threads)
+double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user);
+    auto toSeconds = [](const FILETIME& ft) {
+        return (((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime) * 1e-7;
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#endif
+}
+
+// Pseudo-random file contents, synced so cold runs really hit the disk
+bool generateFile(const string& path, size_t size, uint64_t seed) {
+    ofstream out(path, ios::binary);
+    if (!out) return false;
+
+    vector<uint8_t> chunk(1024 * 1024);
+    size_t written = 0;
+    while (written < size) {
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+            chunk[i] = (uint8_t)seed;
+        }
+        size_t length = min(chunk.size(), size - written);
+        out.write((const char*)chunk.data(), length);
+        written += length;
+    }
+    return (bool)out;
+}
+
+struct RunResult {
+    bool ok;
+    string error;
+    double wallSeconds;
+    double cpuSeconds;
+    vector<string> digests;
+};
+
+// Hash every file with `threads` workers pulling from a shared index
+RunResult runOnce(const vector<string>& files, const string& algorithm, const string& backend,
+                  size_t bufferSize, int threads) {
+    RunResult result;
+    result.ok = true;
+    result.digests.resize(files.size());
+
+    atomic<size_t> nextFile(0);
+    vector<string> errors(threads);
+
+    metrics.setInputBackend(backend.c_str());
+    metrics.filesQueued(files.size());
+
+    double cpuStart = processCpuSeconds();
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            traceThreadName("worker-" + to_string(t));
+            size_t index;
+            while ((index = nextFile.fetch_add(1)) < files.size()) {
+                unique_ptr<DynamicHasher> hasher = createHasher(algorithm);
+                TraceSpan fileSpan("file", hasher->name());
+                metrics.fileStarted();
+                uint64_t hashed = 0;
+                bool ok = readFile(backend, files[index], bufferSize, [&](const uint8_t* data, size_t length) {
+                    TraceSpan span("hash", hasher->name(), length);
+                    hasher->update(data, length);
+                    hashed += length;
+                    metrics.addInputBytes(length);
+                    metrics.addAlgorithmBytes(0, length);
+                }, errors[t]);
+                if (!ok) {
+                    metrics.fileFinished(false);
+                    return;
+                }
+                TraceSpan finalize("finalize", hasher->name());
+                result.digests[index] = hasher->hexdigest();
+                fileSpan.setBytes(hashed);
+                metrics.fileFinished(true);
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    // Files a failed worker never picked up
+    size_t picked = min(nextFile.load(), files.size());
+    for (size_t i = picked; i < files.size(); ++i) {
+        metrics.fileStarted();
+        metrics.fileFinished(false);
+    }
+
+    result.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.cpuSeconds = processCpuSeconds() - cpuStart;
+
+    for (const string& error : errors) {
+        if (!error.empty()) {
+            result.ok = false;
+            result.error = error;
+        }
+    }
+    return result;
+}
+
+// Feed one byte range of a file to consume; each caller uses its own stream
+bool readRange(const string& path, uint64_t offset, uint64_t length, PooledBuffer& buffer,
+               const ChunkConsumer& consume) {
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    in.seekg(offset);
+    while (length > 0) {
+        size_t want = (size_t)min<uint64_t>(buffer.size(), length);
+        {
+            TraceSpan span("read_wait", nullptr, want);
+            in.read((char*)buffer.data(), want);
+        }
+        if ((size_t)in.gcount() != want) return false;
+        consume(buffer.data(), want);
+        length -= want;
+    }
+    return true;
+}
+
+// Split one file into leaves and process them on `threads` workers.
+// leafWork(leafIndex, offset, length, buffer) returns false on failure.
+bool forEachLeafParallel(uint64_t fileSize, size_t leafSize, int threads, size_t bufferSize,
+                         const function<bool(size_t, uint64_t, uint64_t, PooledBuffer&)>& leafWork) {
+    size_t leafCount = max<uint64_t>(1, (fileSize + leafSize - 1) / leafSize);
+    atomic<size_t> nextLeaf(0);
+    atomic<bool> ok(true);
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            PooledBuffer buffer = sharedBufferPool().acquire(bufferSize);
+            size_t leaf;
+            while ((leaf = nextLeaf.fetch_add(1)) < leafCount) {
+                uint64_t offset = (uint64_t)leaf * leafSize;
+                uint64_t length = min<uint64_t>(leafSize, fileSize - min<uint64_t>(offset, fileSize));
+                TraceSpan span("leaf", nullptr, length);
+                if (!leafWork(leaf, offset, length, buffer)) ok = false;
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    return ok;
+}
+
+string treeHash(const string& path, uint64_t fileSize, const string& algorithm, size_t leafSize,
+                int threads, size_t bufferSize) {
+    size_t leafCount = max<uint64_t>(1, (fileSize + leafSize - 1) / leafSize);
+    size_t digestSize = createHasher(algorithm)->digestSize();
+    vector<uint8_t> leafDigests(leafCount * digestSize);
+
+    bool ok = forEachLeafParallel(fileSize, leafSize, threads, bufferSize,
+        [&](size_t leaf, uint64_t offset, uint64_t length, PooledBuffer& buffer) {
+            unique_ptr<DynamicHasher> hasher = createHasher(algorithm);
+            bool read = readRange(path, offset, length, buffer, [&](const uint8_t* data, size_t n) {
+                TraceSpan span("hash", hasher->name(), n);
+                hasher->update(data, n);
+            });
+            hasher->finalize(leafDigests.data() + leaf * digestSize);
+            return read;
+        });
+    if (!ok) return "";
+
+    unique_ptr<DynamicHasher> root = createHasher(algorithm);
+    root->update(leafDigests.data(), leafDigests.size());
+    return root->hexdigest();
+}
+
+string parallelCrc(const string& path, uint64_t fileSize, size_t leafSize, int threads, size_t bufferSize) {
+    size_t leafCount = max<uint64_t>(1, (fileSize + leafSize - 1) / leafSize);
+    vector<uint32_t> leafCrcs(leafCount);
+    vector<uint64_t> leafLengths(leafCount);
+
+    bool ok = forEachLeafParallel(fileSize, leafSize, threads, bufferSize,
+        [&](size_t leaf, uint64_t offset, uint64_t length, PooledBuffer& buffer) {
+            Crc32 crc;
+            bool read = readRange(path, offset, length, buffer, [&](const uint8_t* data, size_t n) {
+                TraceSpan span("hash", "CRC-32", n);
+                crc.update(data, n);
+            });
+            leafCrcs[leaf] = crc.value();
+            leafLengths[leaf] = length;
+            return read;
+        });
+    if (!ok) return "";
+
+    uint32_t combined = leafCrcs[0];
+    for (size_t i = 1; i < leafCount; ++i) {
+        combined = crc32Combine(combined, leafCrcs[i], leafLengths[i]);
+    }
+    uint8_t digest[Crc32::DIGEST_SIZE];
+    for (int i = 0; i < 4; ++i) digest[i] = (combined >> ((3 - i) * 8)) & 0xFF;
+    return toHex(digest, sizeof(digest));
+}
+
+struct ScalingPoint {
+    int threads;
+    double wallSeconds;
+    bool digestOk;
+};
+
+int runScaling(const string& mode, const string& dir, size_t fileSize, int fileCount, string algorithm,
+               const string& backend, size_t bufferSize, size_t leafSize, int maxThreads, bool keep) {
+    if (mode == "crc") algorithm = "CRC-32";
+    if (mode != "files") fileCount = 1;
+
+    vector<string> files;
+    for (int i = 0; i < fileCount; ++i) {
+        string path = dir + "/filebench_" + to_string(fileSize) + "_" + to_string(i) + ".bin";
+        if (!generateFile(path, fileSize, 0x9E3779B97F4A7C15ULL + i)) {
+            cerr << "Cannot write " << path << endl;
+            return 1;
+        }
+        files.push_back(path);
+    }
+
+    // Sequential reference; tree digests are compared against the 1-thread tree instead
+    vector<string> reference = runOnce(files, algorithm, "read", 1024 * 1024, 1).digests;
+    string treeReference;
+
+    vector<ScalingPoint> points;
+    for (int threads = 1; threads <= maxThreads; ++threads) {
+        // Warm the page cache so the sweep measures hashing, not the first read
+        for (const string& path : files) {
+            string ignored;
+            readWithRead(path, 1024 * 1024, [](const uint8_t*, size_t) {}, ignored);
+        }
+
+        ScalingPoint point = {threads, 0, true};
+        auto start = chrono::steady_clock::now();
+        if (mode == "files") {
+            RunResult r = runOnce(files, algorithm, backend, bufferSize, threads);
+            point.digestOk = r.ok && r.digests == reference;
+        } else if (mode == "tree") {
+            string digest = treeHash(files[0], fileSize, algorithm, leafSize, threads, bufferSize);
+            if (threads == 1) treeReference = digest;
+            point.digestOk = !digest.empty() && digest == treeReference;
+        } else {
+            string digest = parallelCrc(files[0], fileSize, leafSize, threads, bufferSize);
+            point.digestOk = digest == reference[0];
+        }
+        point.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        points.push_back(point);
+    }
+
+    double totalMb = (double)fileSize * files.size() / (1024 * 1024);
+    double baseRate = totalMb / points[0].wallSeconds;
+
+    // Knee: last point before the marginal gain per added thread drops below half a thread
+    int knee = points.back().threads;
+    for (size_t i = 0; i + 1 < points.size(); ++i) {
+        double gain = totalMb / points[i + 1].wallSeconds - totalMb / points[i].wallSeconds;
+        if (gain < 0.5 * baseRate) {
+            knee = points[i].threads;
+            break;
+        }
+    }
+
+    cout << "mode,algorithm,files,file_size,threads,wall_s,mb_per_s,speedup,efficiency,knee,status" << endl;
+    for (const ScalingPoint& point : points) {
+        double rate = totalMb / point.wallSeconds;
+        cout << mode << ',' << algorithm << ',' << files.size() << ',' << fileSize << ',' << point.threads << ','
+             << fixed << setprecision(4) << point.wallSeconds << ',' << setprecision(1) << rate << ','
+             << setprecision(2) << rate / baseRate << ',' << rate / baseRate / point.threads << ','
+             << (point.threads == knee ? 1 : 0) << ',' << (point.digestOk ? "ok" : "mismatch") << endl;
+        cout.unsetf(ios::fixed);
+    }
+
+    if (!keep) {
+        for (const string& path : files) remove(path.c_str());
+    }
+    return 0;
+}
+
+// Write the collected spans once all workers have been joined
+bool finishTrace(const string& path) {
+    if (path.empty() || writeChromeTrace(path)) return true;
+    cerr << "Cannot write trace " << path << endl;
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    string dir = ".";
+    vector<string> sizes = {"64M"};
+    int fileCount = 4;
+    string algorithm = "SHA-256";
+    vector<string> backends = availableReadBackends();
+    vector<string> buffers = {"64K", "1M", "4M", "16M"};
+    bool backendsGiven = false;
+    bool buffersGiven = false;
+    vector<string> threadCounts = {"1"};
+    vector<string> cacheModes = {"warm", "cold"};
+    bool keep = false;
+    string scalingMode;
+    int maxThreads = max(1u, thread::hardware_concurrency());
+    size_t leafSize = 4 * 1024 * 1024;
+    string tracePath;
+    string metricsPath;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        string value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--dir") { dir = value; ++i; }
+        else if (arg == "--size") { sizes = splitList(value); ++i; }
+        else if (arg == "--files") { fileCount = atoi(value.c_str()); ++i; }
+        else if (arg == "--algo") { algorithm = value; ++i; }
+        else if (arg == "--backends") { backends = splitList(value); backendsGiven = true; ++i; }
+        else if (arg == "--buffers") { buffers = splitList(value); buffersGiven = true; ++i; }
+        else if (arg == "--threads") { threadCounts = splitList(value); ++i; }
+        else if (arg == "--cache") { cacheModes = splitList(value); ++i; }
+        else if (arg == "--keep") { keep = true; }
+        else if (arg == "--scaling") { scalingMode = value; ++i; }
+        else if (arg == "--max-threads") { maxThreads = max(1, atoi(value.c_str())); ++i; }
+        else if (arg == "--leaf-size") { leafSize = max<size_t>(1, parseSize(value)); ++i; }
+        else if (arg == "--trace") { tracePath = value; ++i; }
+        else if (arg == "--metrics") { metricsPath = value; ++i; }
+        else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+
+    if (!createHasher(algorithm)) {
+        cerr << "Unknown algorithm: " << algorithm << endl;
+        return 1;
+    }
+
+    if (!metricsPath.empty()) {
+        string error;
+        if (!metrics.open(metricsPath, error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        unique_ptr<DynamicHasher> hasher = createHasher(algorithm);
+        metrics.addAlgorithm(hasher->name(), hasher->backend());
+        metrics.start();
+    }
+    if (!tracePath.empty()) {
+        startTracing();
+        traceThreadName("main");
+    }
+
+    if (!scalingMode.empty()) {
+        if (scalingMode != "files" && scalingMode != "tree" && scalingMode != "crc") {
+            cerr << "Unknown scaling mode: " << scalingMode << endl;
+            return 1;
+        }
+        // Scaling uses the first backend and buffer size given; plain read with 1M otherwise
+        string backend = backendsGiven && !backends.empty() ? backends[0] : "read";
+        string buffer = buffersGiven && !buffers.empty() ? buffers[0] : "1M";
+        int status = runScaling(scalingMode, dir, parseSize(sizes[0]), fileCount, algorithm, backend,
+                                parseSize(buffer), leafSize, maxThreads, keep);
+        return finishTrace(tracePath) ? status : 1;
+    }
+
+    cout << "algorithm,backend,file_size,files,buffer_size,threads,cache,status,wall_s,cpu_s,mb_per_s,cpu_per_wall" << endl;
+
+    for (const string& sizeText : sizes) {
+        size_t fileSize = parseSize(sizeText);
+
+        vector<string> files;
+        for (int i = 0; i < fileCount; ++i) {
+            string path = dir + "/filebench_" + to_string(fileSize) + "_" + to_string(i) + ".bin";
+            if (!generateFile(path, fileSize, 0x9E3779B97F4A7C15ULL + i)) {
+                cerr << "Cannot write " << path << endl;
+                return 1;
+            }
+            files.push_back(path);
+        }
+
+        // Reference digests from the plain read path
+        vector<string> reference = runOnce(files, algorithm, "read", 1024 * 1024, 1).digests;
+
+        for (const string& backend : backends) {
+            for (const string& bufferText : buffers) {
+                size_t bufferSize = parseSize(bufferText);
+                for (const string& threadText : threadCounts) {
+                    int threads = max(1, atoi(threadText.c_str()));
+                    for (const string& cache : cacheModes) {
+                        for (const string& path : files) {
+                            if (cache == "cold") {
+                                evictFromPageCache(path);
+                            } else {
+                                string ignored;
+                                readWithRead(path, 1024 * 1024, [](const uint8_t*, size_t) {}, ignored);
+                            }
+                        }
+
+                        RunResult r = runOnce(files, algorithm, backend, bufferSize, threads);
+                        string status = "ok";
+                        if (!r.ok) {
+                            status = "unsupported";
+                            cerr << backend << ": " << r.error << endl;
+                        } else if (r.digests != reference) {
+                            status = "mismatch";
+                        }
+
+                        double totalMb = (double)fileSize * files.size() / (1024 * 1024);
+                        cout << algorithm << ',' << backend << ',' << fileSize << ',' << files.size() << ','
+                             << bufferSize << ',' << threads << ',' << cache << ',' << status << ','
+                             << fixed << setprecision(4) << r.wallSeconds << ',' << r.cpuSeconds << ','
+                             << setprecision(1) << (r.ok ? totalMb / r.wallSeconds : 0.0) << ','
+                             << setprecision(2) << r.cpuSeconds / r.wallSeconds << endl;
+                        cout.unsetf(ios::fixed);
+                    }
+                }
+            }
+        }
+
+        if (!keep) {
+            for (const string& path : files) remove(path.c_str());
+        }
+    }
+
+    return finishTrace(tracePath) ? 0 : 1;
+}
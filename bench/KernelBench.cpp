@@ -0,0 +1,259 @@
+// Kernel micro-benchmark.
+// Hashes in-memory messages from 64 B up to 1 GiB with every algorithm and
+// every kernel variant this CPU supports (see cpu_dispatch.h) and prints
+// cycles/byte and GB/s as CSV (or an aligned table). "SHA-256 mb" rows hash
+// the same bytes as a batch of 256 B records through the multi-buffer kernels.
+// "all" rows run MD5, SHA-1, SHA-256, SHA-512 and CRC-32 over each message,
+// one after another or fused in L1-sized tiles (HashEngine --fused).
+//
+// Usage: KernelBench [--min-size N] [--max-size N] [--min-time SEC]
+//                    [--algo NAME] [--format csv|table]
+//
+// Cycles are TSC ticks on x86 (constant-rate reference cycles, not core
+// clock); elsewhere the column is reported as "nan".
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define HAVE_TSC 1
+#endif
+
+#include "../src/md5.h"
+#include "../src/sha1.h"
+#include "../src/sha2.h"
+#include "../src/sha2_multibuffer.h"
+#include "../src/crc32.h"
+#include "../src/hash_registry.h"
+
+using namespace std;
+
+// One benchmarkable kernel: digest a whole message in one shot
+struct Kernel {
+    string algorithm;
+    string backend;
+    function<void()> select;   // Make this variant the active one
+    function<void(const uint8_t*, size_t)> hash;
+};
+
+template <typename Hasher>
+void oneShot(const uint8_t* data, size_t length) {
+    Hasher hasher;
+    hasher.update(data, length);
+    uint8_t digest[Hasher::DIGEST_SIZE];
+    hasher.finalize(digest);
+    // Keep the result alive so the work is not optimised away
+    asm volatile("" : : "r"(digest) : "memory");
+}
+
+// Every variant of Hasher's dispatch table the CPU can run
+template <typename Hasher>
+void addVariants(vector<Kernel>& kernels, const string& algorithm) {
+    for (const auto& variant : Hasher::dispatch().variants()) {
+        if (!variant.supported) continue;
+        string backend = variant.name;
+        kernels.push_back({algorithm, backend, [backend]() { Hasher::dispatch().select(backend.c_str()); },
+                           oneShot<Hasher>});
+    }
+}
+
+// The message cut into 256 B records and hashed as one batch, as
+// shahash_hash_many does; compare with SHA-256 one-shot at the same size
+constexpr size_t BATCH_RECORD_SIZE = 256;
+
+void hashBatch(const uint8_t* data, size_t length) {
+    static vector<MessageView> records;
+    static vector<uint8_t> digests;
+    records.clear();
+    for (size_t offset = 0; offset < length || records.empty(); offset += BATCH_RECORD_SIZE) {
+        records.push_back({data + offset, min(BATCH_RECORD_SIZE, length - offset)});
+    }
+    digests.resize(records.size() * 32);
+    sha256ManyDispatch().function()(Sha256Traits::IV, 32, records.data(), records.size(), digests.data());
+    asm volatile("" : : "r"(digests.data()) : "memory");
+}
+
+void addBatchVariants(vector<Kernel>& kernels) {
+    for (const auto& variant : sha256ManyDispatch().variants()) {
+        if (!variant.supported) continue;
+        string backend = variant.name;
+        kernels.push_back({"SHA-256 mb", backend, [backend]() { sha256ManyDispatch().select(backend.c_str()); },
+                           hashBatch});
+    }
+}
+
+// Every benchmarked algorithm over the same message: one after another
+// ("sequential"), or interleaved tile by tile ("fused-8K", see fusedUpdate)
+const char* const FUSED_ALGORITHMS[] = {"MD5", "SHA-1", "SHA-256", "SHA-512", "CRC-32"};
+
+void hashAll(const uint8_t* data, size_t length, size_t tileSize) {
+    static vector<unique_ptr<DynamicHasher>> hashers;
+    if (hashers.empty()) {
+        for (const char* name : FUSED_ALGORITHMS) hashers.push_back(createHasher(name));
+    }
+    for (auto& hasher : hashers) hasher->reset();
+    fusedUpdate(hashers, data, length, tileSize ? tileSize : max<size_t>(length, 1));
+    uint8_t digest[64];
+    for (auto& hasher : hashers) hasher->finalize(digest);
+    asm volatile("" : : "r"(digest) : "memory");
+}
+
+void addFusedVariants(vector<Kernel>& kernels) {
+    auto noSelect = []() {};
+    kernels.push_back({"all", "sequential", noSelect, [](const uint8_t* data, size_t length) { hashAll(data, length, 0); }});
+    for (size_t tile : {4096, 8192, 16384, 65536}) {
+        kernels.push_back({"all", "fused-" + to_string(tile / 1024) + "K", noSelect,
+                           [tile](const uint8_t* data, size_t length) { hashAll(data, length, tile); }});
+    }
+}
+
+vector<Kernel> allKernels() {
+    vector<Kernel> kernels;
+    addVariants<Md5>(kernels, "MD5");
+    addVariants<Sha1>(kernels, "SHA-1");
+    addVariants<Sha256>(kernels, "SHA-256");
+    addBatchVariants(kernels);
+    addVariants<Sha512>(kernels, "SHA-512");
+    addVariants<Crc32>(kernels, "CRC-32");
+    addFusedVariants(kernels);
+    return kernels;
+}
+
+struct Result {
+    uint64_t iterations;
+    double nsPerIteration;
+    double cyclesPerIteration;
+};
+
+inline uint64_t readCycles() {
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Run batches until minTime has elapsed; keep the fastest batch
+Result measure(const Kernel& kernel, const uint8_t* data, size_t size, double minTime) {
+    typedef chrono::steady_clock Clock;
+
+    Result best = {0, INFINITY, INFINITY};
+    uint64_t batch = 1;
+    double elapsedTotal = 0;
+
+    // Warm up caches and branch predictors
+    kernel.hash(data, size);
+
+    while (elapsedTotal < minTime) {
+        auto start = Clock::now();
+        uint64_t cycleStart = readCycles();
+        for (uint64_t i = 0; i < batch; ++i) {
+            kernel.hash(data, size);
+        }
+        uint64_t cycleEnd = readCycles();
+        double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+
+        elapsedTotal += ns * 1e-9;
+        double perIteration = ns / batch;
+        if (perIteration < best.nsPerIteration) {
+            best.iterations = batch;
+            best.nsPerIteration = perIteration;
+            best.cyclesPerIteration = (double)(cycleEnd - cycleStart) / batch;
+        }
+
+        // Grow short batches so timer overhead stays negligible
+        if (ns < 1e6) batch *= 2;
+    }
+    return best;
+}
+
+size_t parseSize(const string& text) {
+    size_t multiplier = 1;
+    string digits = text;
+    char suffix = digits.empty() ? 0 : toupper(digits.back());
+    if (suffix == 'K') multiplier = 1024;
+    if (suffix == 'M') multiplier = 1024 * 1024;
+    if (suffix == 'G') multiplier = 1024 * 1024 * 1024;
+    if (multiplier > 1) digits.pop_back();
+    return stoull(digits) * multiplier;
+}
+
+int main(int argc, char* argv[]) {
+    size_t minSize = 64;
+    size_t maxSize = 1024 * 1024 * 1024;
+    double minTime = 0.2;
+    string onlyAlgorithm;
+    bool table = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        string value = (i + 1 < argc) ? argv[i + 1] : "";
+        try {
+            if (arg == "--min-size") { minSize = parseSize(value); ++i; }
+            else if (arg == "--max-size") { maxSize = parseSize(value); ++i; }
+            else if (arg == "--min-time") { minTime = stod(value); ++i; }
+            else if (arg == "--algo") { onlyAlgorithm = value; ++i; }
+            else if (arg == "--format") { table = (value == "table"); ++i; }
+            else {
+                cerr << "Unknown option: " << arg << endl;
+                return 1;
+            }
+        } catch (...) {
+            cerr << "Invalid value for " << arg << ": " << value << endl;
+            return 1;
+        }
+    }
+
+    // Pseudo-random message, shared by every size
+    vector<uint8_t> message(maxSize);
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < maxSize; ++i) {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        message[i] = (uint8_t)seed;
+    }
+
+    if (table) {
+        cout << left << setw(12) << "algorithm" << setw(10) << "backend" << right
+             << setw(12) << "size" << setw(12) << "iterations"
+             << setw(14) << "ns/iter" << setw(12) << "cycles/B" << setw(10) << "GB/s" << endl;
+    } else {
+        cout << "algorithm,backend,size,iterations,ns_per_iter,cycles_per_byte,gb_per_s" << endl;
+    }
+
+    for (const Kernel& kernel : allKernels()) {
+        if (!onlyAlgorithm.empty() && kernel.algorithm != onlyAlgorithm) continue;
+        kernel.select();
+
+        for (size_t size = minSize; size <= maxSize; size *= 4) {
+            Result r = measure(kernel, message.data(), size, minTime);
+            double gbPerSecond = size / r.nsPerIteration;
+#ifdef HAVE_TSC
+            double cyclesPerByte = r.cyclesPerIteration / size;
+#else
+            double cyclesPerByte = NAN;
+#endif
+            if (table) {
+                cout << left << setw(12) << kernel.algorithm << setw(10) << kernel.backend << right
+                     << setw(12) << size << setw(12) << r.iterations
+                     << fixed << setprecision(1) << setw(14) << r.nsPerIteration
+                     << setprecision(2) << setw(12) << cyclesPerByte
+                     << setprecision(3) << setw(10) << gbPerSecond << endl;
+            } else {
+                cout << kernel.algorithm << ',' << kernel.backend << ',' << size << ',' << r.iterations << ','
+                     << fixed << setprecision(1) << r.nsPerIteration << ','
+                     << setprecision(3) << cyclesPerByte << ',' << gbPerSecond << endl;
+            }
+            cout.unsetf(ios::fixed);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+Head-to-head benchmark: native engines vs. Python stdlib (hashlib/zlib).
+
+HashCalculator.calculate_file sends SHA-256/384/512 and CRC-32 to
+hashlib/zlib because the subprocess path used to be slower. This script
+hashes identical files both ways and reports the throughput ratio per
+algorithm and size:
+
+  native  the file streamed into the algorithm's executable over stdin in
+          16 MB chunks, as _calculate_file_subprocess does it
+  stdlib  hashlib / zlib.crc32 over the same file in 16 MB chunks, as the
+          fast path in calculate_file does it
+
+ratio = native MB/s / stdlib MB/s. The exit status is non-zero if the
+native path loses anywhere (ratio below 1 - tolerance) or if any digest
+differs, so it can gate moving an algorithm onto the native engine.
+
+Usage: python bench/compare_stdlib.py [--algo SHA-256,CRC-32|all] [--size 1M,64M,512M]
+                                      [--repeat N] [--tolerance 0.05] [--dir PATH]
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+import zlib
+
+CHUNK_SIZE = 16 * 1024 * 1024
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+BIN_DIR = os.path.join(ROOT, 'bin')
+CREATION_FLAGS = subprocess.CREATE_NO_WINDOW if hasattr(subprocess, 'CREATE_NO_WINDOW') else 0
+
+# Algorithms calculate_file currently routes to the stdlib
+DEFAULT_ALGORITHMS = ['SHA-256', 'SHA-384', 'SHA-512', 'CRC-32']
+
+HASHLIB_NAMES = {
+    'MD5': 'md5',
+    'SHA-1': 'sha1',
+    'SHA-224': 'sha224',
+    'SHA-256': 'sha256',
+    'SHA-384': 'sha384',
+    'SHA-512': 'sha512',
+    'SHA-512/224': 'sha512_224',
+    'SHA-512/256': 'sha512_256',
+}
+
+
+def parse_size(text):
+    multipliers = {'K': 1024, 'M': 1024 ** 2, 'G': 1024 ** 3}
+    suffix = text[-1].upper()
+    if suffix in multipliers:
+        return int(text[:-1]) * multipliers[suffix]
+    return int(text)
+
+
+def load_executables():
+    with open(os.path.join(ROOT, 'app', 'algorithms.json')) as f:
+        config = json.load(f)
+    return {a['name']: os.path.join(BIN_DIR, a['executable'])
+            for a in config['algorithms'] if a.get('type') == 'executable'}
+
+
+def hash_native(executable, file_path):
+    """Stream the file through the executable the way the GUI does."""
+    file_size = os.path.getsize(file_path)
+    proc = subprocess.Popen(
+        [executable, str(file_size)],
+        stdin=subprocess.PIPE,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.DEVNULL,
+        bufsize=0,
+        creationflags=CREATION_FLAGS
+    )
+    with open(file_path, 'rb') as f:
+        while True:
+            chunk = f.read(CHUNK_SIZE)
+            if not chunk:
+                break
+            proc.stdin.write(chunk)
+    proc.stdin.close()
+    stdout = proc.stdout.read()
+    proc.wait()
+    if proc.returncode != 0:
+        raise RuntimeError(f"{executable} failed with exit code {proc.returncode}")
+    return stdout.decode('utf-8').strip()
+
+
+def hash_stdlib(algorithm, file_path):
+    if algorithm == 'CRC-32':
+        crc = 0
+        with open(file_path, 'rb') as f:
+            while True:
+                chunk = f.read(CHUNK_SIZE)
+                if not chunk:
+                    break
+                crc = zlib.crc32(chunk, crc)
+        return format(crc & 0xFFFFFFFF, '08x')
+
+    h = hashlib.new(HASHLIB_NAMES[algorithm])
+    with open(file_path, 'rb') as f:
+        while True:
+            chunk = f.read(CHUNK_SIZE)
+            if not chunk:
+                break
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def best_time(function, repeat):
+    """Fastest of `repeat` runs; the first run also warms the page cache."""
+    best = float('inf')
+    result = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        result = function()
+        best = min(best, time.perf_counter() - start)
+    return best, result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--algo', default=','.join(DEFAULT_ALGORITHMS),
+                        help="comma-separated algorithm names, or 'all'")
+    parser.add_argument('--size', default='1M,64M,512M', help='comma-separated file sizes')
+    parser.add_argument('--repeat', type=int, default=3, help='runs per measurement; the fastest counts')
+    parser.add_argument('--tolerance', type=float, default=0.05,
+                        help='native may be this fraction slower before it counts as losing')
+    parser.add_argument('--dir', default=None, help='directory for the temporary input files')
+    args = parser.parse_args()
+
+    executables = load_executables()
+    if args.algo == 'all':
+        algorithms = [a for a in executables if a in HASHLIB_NAMES or a == 'CRC-32']
+    else:
+        algorithms = [a for a in args.algo.split(',') if a]
+
+    for algorithm in algorithms:
+        if algorithm not in executables or not os.path.exists(executables[algorithm]):
+            sys.exit(f"No native executable for {algorithm} (run build.bat / build.sh first)")
+        if algorithm not in HASHLIB_NAMES and algorithm != 'CRC-32':
+            sys.exit(f"No stdlib implementation for {algorithm}")
+
+    losses = 0
+    mismatches = 0
+    print('algorithm,size,native_mb_s,stdlib_mb_s,ratio,verdict')
+
+    for size_text in args.size.split(','):
+        size = parse_size(size_text)
+        fd, file_path = tempfile.mkstemp(prefix='compare_stdlib_', suffix='.bin', dir=args.dir)
+        try:
+            with os.fdopen(fd, 'wb') as f:
+                remaining = size
+                while remaining > 0:
+                    block = os.urandom(min(CHUNK_SIZE, remaining))
+                    f.write(block)
+                    remaining -= len(block)
+
+            for algorithm in algorithms:
+                native_time, native_digest = best_time(
+                    lambda: hash_native(executables[algorithm], file_path), args.repeat)
+                stdlib_time, stdlib_digest = best_time(
+                    lambda: hash_stdlib(algorithm, file_path), args.repeat)
+
+                native_rate = size / (1024 * 1024) / native_time
+                stdlib_rate = size / (1024 * 1024) / stdlib_time
+                ratio = native_rate / stdlib_rate
+
+                if native_digest != stdlib_digest:
+                    verdict = 'mismatch'
+                    mismatches += 1
+                elif ratio < 1.0 - args.tolerance:
+                    verdict = 'native-loses'
+                    losses += 1
+                else:
+                    verdict = 'native-ok'
+
+                print(f"{algorithm},{size},{native_rate:.1f},{stdlib_rate:.1f},{ratio:.3f},{verdict}")
+                sys.stdout.flush()
+        finally:
+            os.remove(file_path)
+
+    if mismatches:
+        print(f"{mismatches} digest mismatch(es) between native and stdlib", file=sys.stderr)
+        sys.exit(2)
+    if losses:
+        print(f"native path slower than stdlib in {losses} case(s)", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
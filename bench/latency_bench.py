@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+Small-message latency benchmark.
+
+Measures p50/p99 time-to-digest for 0 B - 4 KiB inputs through each way
+the GUI can reach the native code:
+
+  subprocess  subprocess.run of the per-algorithm executable, exactly as
+              HashCalculator.calculate_text_sync does it
+  engine      one persistent `HashEngine --serve` process, request over pipes
+  inprocess   direct library calls inside the engine (`HashEngine --latency`)
+
+Each row also breaks the time down: `compute_p50_us` is the in-process cost
+of the same hash, and `overhead_p50_us` is what the invocation path adds on
+top. For subprocess, `startup_p50_us` is the cost of a run on empty input,
+i.e. process creation plus runtime initialisation.
+
+Usage: python bench/latency_bench.py [--iterations N] [--algo NAME,...] [--format csv|table]
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import time
+
+SIZES = [0, 16, 64, 256, 1024, 4096]
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+BIN_DIR = os.path.join(ROOT, 'bin')
+CREATION_FLAGS = subprocess.CREATE_NO_WINDOW if hasattr(subprocess, 'CREATE_NO_WINDOW') else 0
+
+
+def percentile(samples, fraction):
+    ordered = sorted(samples)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * fraction))]
+
+
+def load_executables():
+    """Map algorithm name to its per-algorithm executable from algorithms.json."""
+    with open(os.path.join(ROOT, 'app', 'algorithms.json')) as f:
+        config = json.load(f)
+    return {a['name']: os.path.join(BIN_DIR, a['executable'])
+            for a in config['algorithms'] if a.get('type') == 'executable'}
+
+
+def time_subprocess(executable, payload, iterations):
+    samples = []
+    for _ in range(iterations):
+        start = time.perf_counter()
+        subprocess.run(
+            [executable],
+            input=payload,
+            capture_output=True,
+            check=True,
+            timeout=30,
+            creationflags=CREATION_FLAGS
+        )
+        samples.append((time.perf_counter() - start) * 1e6)
+    return samples
+
+
+class EngineClient:
+    """Talks to a persistent `HashEngine --serve` process."""
+
+    def __init__(self, engine_path):
+        self.proc = subprocess.Popen(
+            [engine_path, '--serve'],
+            stdin=subprocess.PIPE,
+            stdout=subprocess.PIPE,
+            creationflags=CREATION_FLAGS
+        )
+
+    def hash(self, algorithm, payload):
+        self.proc.stdin.write(f"HASH {len(payload)} {algorithm}\n".encode() + payload)
+        self.proc.stdin.flush()
+        reply = self.proc.stdout.readline().decode().strip()
+        if reply.startswith('ERROR'):
+            raise RuntimeError(reply)
+        return reply
+
+    def close(self):
+        self.proc.stdin.close()
+        self.proc.wait()
+
+
+def time_engine(client, algorithm, payload, iterations):
+    samples = []
+    for _ in range(iterations):
+        start = time.perf_counter()
+        client.hash(algorithm, payload)
+        samples.append((time.perf_counter() - start) * 1e6)
+    return samples
+
+
+def inprocess_latency(engine_path, iterations):
+    """Parse `HashEngine --latency` CSV into {(algorithm, size): (p50, p99)}."""
+    output = subprocess.run([engine_path, '--latency', str(iterations)],
+                            capture_output=True, check=True,
+                            creationflags=CREATION_FLAGS).stdout.decode()
+    results = {}
+    for line in output.splitlines()[1:]:
+        algorithm, size, _, p50, p99 = line.split(',')
+        results[(algorithm, int(size))] = (float(p50), float(p99))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--iterations', type=int, default=200,
+                        help='samples per point for subprocess (engine/in-process use 10x)')
+    parser.add_argument('--algo', default='', help='comma-separated algorithm names (default: all)')
+    parser.add_argument('--format', choices=['csv', 'table'], default='csv')
+    args = parser.parse_args()
+
+    executables = load_executables()
+    engine_path = os.path.join(BIN_DIR, 'HashEngine.exe')
+    if not os.path.exists(engine_path):
+        sys.exit(f"Engine not found: {engine_path} (run build.bat / build.sh first)")
+
+    algorithms = [a for a in args.algo.split(',') if a] or list(executables)
+    payloads = {size: os.urandom(size) for size in SIZES}
+
+    compute = inprocess_latency(engine_path, args.iterations * 10)
+    client = EngineClient(engine_path)
+
+    rows = []
+    try:
+        for algorithm in algorithms:
+            executable = executables.get(algorithm)
+            startup = None
+            if executable and os.path.exists(executable):
+                startup = statistics.median(time_subprocess(executable, b'', args.iterations))
+
+            for size in SIZES:
+                compute_p50, compute_p99 = compute.get((algorithm, size), (0.0, 0.0))
+                rows.append(('inprocess', algorithm, size, compute_p50, compute_p99, compute_p50, 0.0, ''))
+
+                samples = time_engine(client, algorithm, payloads[size], args.iterations * 10)
+                p50 = percentile(samples, 0.5)
+                rows.append(('engine', algorithm, size, p50, percentile(samples, 0.99),
+                             compute_p50, p50 - compute_p50, ''))
+
+                if startup is not None:
+                    samples = time_subprocess(executable, payloads[size], args.iterations)
+                    p50 = percentile(samples, 0.5)
+                    rows.append(('subprocess', algorithm, size, p50, percentile(samples, 0.99),
+                                 compute_p50, p50 - compute_p50, f"{startup:.1f}"))
+    finally:
+        client.close()
+
+    header = ('path', 'algorithm', 'size', 'p50_us', 'p99_us', 'compute_p50_us', 'overhead_p50_us', 'startup_p50_us')
+    if args.format == 'table':
+        print(f"{header[0]:<11}{header[1]:<13}{header[2]:>6}{header[3]:>11}{header[4]:>11}"
+              f"{header[5]:>16}{header[6]:>17}{header[7]:>16}")
+        for path, algorithm, size, p50, p99, comp, overhead, startup in rows:
+            print(f"{path:<11}{algorithm:<13}{size:>6}{p50:>11.1f}{p99:>11.1f}"
+                  f"{comp:>16.2f}{overhead:>17.1f}{startup:>16}")
+    else:
+        print(','.join(header))
+        for path, algorithm, size, p50, p99, comp, overhead, startup in rows:
+            print(f"{path},{algorithm},{size},{p50:.2f},{p99:.2f},{comp:.3f},{overhead:.2f},{startup}")
+
+
+if __name__ == '__main__':
+    main()
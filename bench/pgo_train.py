@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Training workload and before/after report for the PGO + LTO build.
+
+  train BIN_DIR          run the instrumented shipped executables over a
+                         representative mix: every algorithm, 0 B - 8 MiB
+                         inputs (short inputs weighted heavily so the
+                         padding/finalise paths get profiled), every input
+                         path (per-algorithm executables over stdin,
+                         HashEngine --algo/--serve)
+  measure BIN_DIR OUT    time the shipped executables on inputs the training
+                         never used: each per-algorithm executable and
+                         HashEngine --algo over stdin (best wall time of
+                         several runs), and HashEngine --latency (p50), as CSV
+  compare BEFORE AFTER   join two measure CSV files and print the speedup
+                         per measurement
+
+Used by build_pgo.sh / build_pgo.bat. The benchmarks are neither trained nor
+used for the report, so the speedup is that of the binaries users run.
+"""
+
+import csv
+import json
+import os
+import subprocess
+import sys
+import time
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+CREATION_FLAGS = subprocess.CREATE_NO_WINDOW if hasattr(subprocess, 'CREATE_NO_WINDOW') else 0
+
+# Many short messages, a few large ones
+TRAINING_SIZES = [0, 1, 3, 55, 56, 63, 64, 65, 111, 112, 127, 128, 129, 1000, 4096, 65536, 1024 * 1024 + 7,
+                  8 * 1024 * 1024]
+# Held out from training, so the report does not measure the training inputs
+MEASURE_SIZES = [7, 300, 5000, 200000, 3 * 1024 * 1024 + 5, 24 * 1024 * 1024 + 1]
+MEASURE_RUNS = 5
+LATENCY_ITERATIONS = 2000
+
+
+def load_executables(bin_dir):
+    with open(os.path.join(ROOT, 'app', 'algorithms.json')) as f:
+        config = json.load(f)
+    return {a['name']: os.path.join(bin_dir, a['executable'])
+            for a in config['algorithms'] if a.get('type') == 'executable'}
+
+
+def run(command, payload=b''):
+    subprocess.run(command, input=payload, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL,
+                   check=True, creationflags=CREATION_FLAGS)
+
+
+def train(bin_dir):
+    executables = load_executables(bin_dir)
+    payloads = {size: os.urandom(size) for size in TRAINING_SIZES}
+
+    # Per-algorithm executables, with and without the expected size argument
+    for name, executable in executables.items():
+        for size, payload in payloads.items():
+            run([executable], payload)
+            run([executable, str(size)], payload)
+
+    engine = os.path.join(bin_dir, 'HashEngine.exe')
+    if os.path.exists(engine):
+        every = ','.join(executables)
+        for size in (0, 64, 65536, 8 * 1024 * 1024):
+            run([engine, '--algo', every, str(size)], payloads[size])
+
+        requests = b''
+        for name in executables:
+            for size in TRAINING_SIZES[:15]:
+                requests += f"HASH {size} {name}\n".encode() + payloads[size]
+        run([engine, '--serve'], requests)
+
+
+def best_wall_us(command, payload):
+    best = None
+    for _ in range(MEASURE_RUNS):
+        start = time.perf_counter()
+        run(command, payload)
+        elapsed = (time.perf_counter() - start) * 1e6
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def measure(bin_dir, out_path):
+    """Rows of (source, algorithm, size, microseconds); lower is better."""
+    executables = load_executables(bin_dir)
+    rows = []
+    for size in MEASURE_SIZES:
+        payload = os.urandom(size)
+        for name, executable in executables.items():
+            rows.append(('executable', name, size, best_wall_us([executable, str(size)], payload)))
+
+    engine = os.path.join(bin_dir, 'HashEngine.exe')
+    if os.path.exists(engine):
+        every = ','.join(executables)
+        for size in MEASURE_SIZES:
+            rows.append(('engine', every, size, best_wall_us([engine, '--algo', every, str(size)], os.urandom(size))))
+
+        output = subprocess.run([engine, '--latency', str(LATENCY_ITERATIONS)], capture_output=True, text=True,
+                                check=True, creationflags=CREATION_FLAGS).stdout
+        for row in csv.DictReader(output.splitlines()):
+            rows.append(('latency', row['algorithm'], int(row['size']), float(row['p50_us'])))
+
+    with open(out_path, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['source', 'algorithm', 'size', 'us'])
+        for source, algorithm, size, us in rows:
+            writer.writerow([source, algorithm, size, f"{us:.3f}"])
+
+
+def load_times(path):
+    with open(path) as f:
+        return {(row['source'], row['algorithm'], int(row['size'])): float(row['us'])
+                for row in csv.DictReader(f)}
+
+
+def compare(before_path, after_path):
+    before = load_times(before_path)
+    after = load_times(after_path)
+
+    # executable/engine: wall time of one run over stdin; latency: in-process p50
+    print(f"{'source':<11}{'algorithm':<12}{'size':>10}{'before_us':>13}{'after_us':>13}{'speedup':>9}")
+    for key in sorted(before):
+        if key not in after or after[key] == 0:
+            continue
+        source, algorithm, size = key
+        if source == 'engine':
+            algorithm = 'all'
+        print(f"{source:<11}{algorithm:<12}{size:>10}{before[key]:>13.1f}{after[key]:>13.1f}"
+              f"{before[key] / after[key]:>8.2f}x")
+
+
+def main():
+    if len(sys.argv) == 3 and sys.argv[1] == 'train':
+        train(sys.argv[2])
+    elif len(sys.argv) == 4 and sys.argv[1] == 'measure':
+        measure(sys.argv[2], sys.argv[3])
+    elif len(sys.argv) == 4 and sys.argv[1] == 'compare':
+        compare(sys.argv[2], sys.argv[3])
+    else:
+        sys.exit("Usage: pgo_train.py train BIN_DIR | measure BIN_DIR OUT.csv | compare BEFORE.csv AFTER.csv")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""
+Reader for the live metrics file written by `HashEngine --algo ... --metrics FILE`
+and `FileBench --metrics FILE` (layout documented in src/live_metrics.h).
+
+Prints one snapshot, or keeps printing every --interval seconds with --follow
+until the writer marks the file finished. --json emits one JSON object per
+snapshot instead of the text summary, for scraping.
+
+The POSIX writer updates the file in place under a seqlock: a snapshot is
+only accepted when the sequence number is even and unchanged across the copy.
+
+Usage: python bench/watch_metrics.py FILE [--follow] [--interval 0.5] [--json]
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+
+MAGIC = b'HASHMET2'
+HEADER = struct.Struct('<8sQQQQQQQQQQdII24s')
+ALGORITHM = struct.Struct('<16s16sQ')
+MAX_ALGORITHMS = 16
+BLOCK_SIZE = HEADER.size + MAX_ALGORITHMS * ALGORITHM.size
+
+
+def _text(raw):
+    return raw.split(b'\0', 1)[0].decode('ascii', 'replace')
+
+
+def read_snapshot(path, retries=100):
+    """Consistent snapshot as a dict, or None if the file is not a metrics file."""
+    for _ in range(retries):
+        with open(path, 'rb') as f:
+            data = f.read(BLOCK_SIZE)
+        if len(data) < BLOCK_SIZE or data[:8] != MAGIC:
+            return None
+        sequence = struct.unpack_from('<Q', data, 8)[0]
+        if sequence % 2:
+            time.sleep(0.001)
+            continue
+        # Re-read the sequence: an update that started after our copy invalidates it
+        with open(path, 'rb') as f:
+            f.seek(8)
+            if struct.unpack('<Q', f.read(8))[0] != sequence:
+                continue
+
+        (_, sequence, pid, start_ns, update_ns, files_done, files_queued, files_active, queue_depth,
+         errors, input_bytes, bytes_per_second, algorithm_count, finished, backend) = HEADER.unpack_from(data)
+        algorithms = []
+        for i in range(min(algorithm_count, MAX_ALGORITHMS)):
+            name, kernel, hashed = ALGORITHM.unpack_from(data, HEADER.size + i * ALGORITHM.size)
+            algorithms.append({'name': _text(name), 'kernel': _text(kernel), 'bytes': hashed})
+        return {
+            'pid': pid,
+            'elapsed_s': (update_ns - start_ns) / 1e9,
+            'age_s': max(0.0, time.time() - update_ns / 1e9),
+            'files_done': files_done,
+            'files_queued': files_queued,
+            'files_active': files_active,
+            'queue_depth': queue_depth,
+            'errors': errors,
+            'input_bytes': input_bytes,
+            'bytes_per_second': bytes_per_second,
+            'input_backend': _text(backend),
+            'finished': bool(finished),
+            'algorithms': algorithms,
+        }
+    return None
+
+
+def format_snapshot(s):
+    lines = [f"pid {s['pid']}  {'finished' if s['finished'] else 'running'}  {s['elapsed_s']:.1f} s  "
+             f"input {s['input_backend']}",
+             f"  files  done {s['files_done']}  active {s['files_active']}  queued {s['files_queued']}  "
+             f"errors {s['errors']}  queue depth {s['queue_depth']}",
+             f"  input  {s['input_bytes'] / 2**20:.1f} MB  {s['bytes_per_second'] / 2**20:.1f} MB/s"]
+    for a in s['algorithms']:
+        lines.append(f"  {a['name']:<12} {a['kernel']:<8} {a['bytes'] / 2**20:.1f} MB")
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('path')
+    parser.add_argument('--follow', action='store_true', help='keep printing until the job finishes')
+    parser.add_argument('--interval', type=float, default=0.5)
+    parser.add_argument('--json', action='store_true')
+    args = parser.parse_args()
+
+    while True:
+        try:
+            snapshot = read_snapshot(args.path)
+        except OSError as e:
+            sys.exit(f"Cannot read {args.path}: {e}")
+        if snapshot is None:
+            sys.exit(f"{args.path} is not a metrics file")
+
+        print(json.dumps(snapshot) if args.json else format_snapshot(snapshot), flush=True)
+        if not args.follow or snapshot['finished']:
+            break
+        time.sleep(args.interval)
+
+
+if __name__ == '__main__':
+    main()
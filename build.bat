@@ -4,42 +4,93 @@ echo.
 
 if not exist bin mkdir bin
 
-g++ -O3 -march=native -o bin/Sha256.exe src/Sha256.cpp
+g++ -O3 -o bin/Sha224.exe src/Sha224.cpp
+if %errorlevel% neq 0 (
+    echo Error compiling Sha224.cpp
+    exit /b %errorlevel%
+)
+
+g++ -O3 -o bin/Sha256.exe src/Sha256.cpp
 if %errorlevel% neq 0 (
     echo Error compiling Sha256.cpp
     exit /b %errorlevel%
 )
 
-g++ -O3 -march=native -o bin/Sha384.exe src/Sha384.cpp  
+g++ -O3 -o bin/Sha384.exe src/Sha384.cpp  
 if %errorlevel% neq 0 (
     echo Error compiling Sha384.cpp
     exit /b %errorlevel%
 )
 
-g++ -O3 -march=native -o bin/Sha512.exe src/Sha512.cpp
+g++ -O3 -o bin/Sha512.exe src/Sha512.cpp
 if %errorlevel% neq 0 (
     echo Error compiling Sha512.cpp
     exit /b %errorlevel%
 )
 
-g++ -O3 -march=native -o bin/Crc.exe src/Crc.cpp
+g++ -O3 -o bin/Sha512_224.exe src/Sha512_224.cpp
+if %errorlevel% neq 0 (
+    echo Error compiling Sha512_224.cpp
+    exit /b %errorlevel%
+)
+
+g++ -O3 -o bin/Sha512_256.exe src/Sha512_256.cpp
+if %errorlevel% neq 0 (
+    echo Error compiling Sha512_256.cpp
+    exit /b %errorlevel%
+)
+
+g++ -O3 -o bin/Crc.exe src/Crc.cpp
 if %errorlevel% neq 0 (
     echo Error compiling Crc.cpp
     exit /b %errorlevel%
 )
 
-g++ -O3 -march=native -o bin/Md5.exe src/Md5.cpp
+g++ -O3 -o bin/Md5.exe src/Md5.cpp
 if %errorlevel% neq 0 (
     echo Error compiling Md5.cpp
     exit /b %errorlevel%
 )
 
-g++ -O3 -march=native -o bin/Sha1.exe src/Sha1.cpp
+g++ -O3 -o bin/Sha1.exe src/Sha1.cpp
 if %errorlevel% neq 0 (
     echo Error compiling Sha1.cpp
     exit /b %errorlevel%
 )
 
+g++ -O3 -pthread -o bin/HashEngine.exe src/HashEngine.cpp
+if %errorlevel% neq 0 (
+    echo Error compiling HashEngine.cpp
+    exit /b %errorlevel%
+)
+
+g++ -O3 -o bin/KernelBench.exe bench/KernelBench.cpp
+if %errorlevel% neq 0 (
+    echo Error compiling KernelBench.cpp
+    exit /b %errorlevel%
+)
+
+g++ -O3 -pthread -o bin/FileBench.exe bench/FileBench.cpp
+if %errorlevel% neq 0 (
+    echo Error compiling FileBench.cpp
+    exit /b %errorlevel%
+)
+
+rem HashServer (src/HashServer.cpp) is built by build.sh only: it needs epoll
+
+rem C ABI library for FFI consumers (src/shahash.h); only shahash_* is exported
+g++ -O3 -shared -o bin/shahash.dll src/shahash.cpp
+if %errorlevel% neq 0 (
+    echo Error compiling shahash.cpp
+    exit /b %errorlevel%
+)
+
+rem Optional in-process extension for the GUI; the executables are enough without it
+python setup.py build_ext --inplace --compiler=mingw32 >nul 2>&1
+if %errorlevel% neq 0 (
+    echo Python extension _shahash not built; the GUI will use the executables
+)
+
 echo.
 echo All executables compiled successfully!
-echo Optimization flags: -O3 -march=native
+echo Optimization flags: -O3
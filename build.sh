@@ -0,0 +1,41 @@
+#!/bin/sh
+# POSIX counterpart of build.bat (Linux/macOS hosts)
+set -e
+
+echo "Compiling Hash Algorithms with optimizations..."
+echo
+
+mkdir -p bin
+
+CXXFLAGS="-O3"
+
+for name in Sha224 Sha256 Sha384 Sha512 Sha512_224 Sha512_256 Crc Md5 Sha1; do
+    g++ $CXXFLAGS -o bin/$name.exe src/$name.cpp || { echo "Error compiling $name.cpp"; exit 1; }
+done
+
+g++ $CXXFLAGS -pthread -o bin/HashEngine.exe src/HashEngine.cpp || { echo "Error compiling HashEngine.cpp"; exit 1; }
+
+for name in KernelBench FileBench; do
+    g++ $CXXFLAGS -pthread -o bin/$name.exe bench/$name.cpp || { echo "Error compiling $name.cpp"; exit 1; }
+done
+
+# Coroutine server for many concurrent uploads; epoll, so Linux only
+if [ "$(uname)" = "Linux" ]; then
+    g++ $CXXFLAGS -std=c++20 -pthread -o bin/HashServer.exe src/HashServer.cpp || { echo "Error compiling HashServer.cpp"; exit 1; }
+fi
+
+# C ABI library for FFI consumers (src/shahash.h); only shahash_* is exported
+if [ "$(uname)" = "Linux" ]; then
+    g++ $CXXFLAGS -shared -fPIC -fvisibility=hidden -Wl,-soname,libshahash.so.1 -Wl,--version-script=src/shahash.map \
+        -o bin/libshahash.so.1 src/shahash.cpp || { echo "Error compiling shahash.cpp"; exit 1; }
+    ln -sf libshahash.so.1 bin/libshahash.so
+else
+    g++ $CXXFLAGS -shared -fPIC -fvisibility=hidden -o bin/libshahash.so src/shahash.cpp || { echo "Error compiling shahash.cpp"; exit 1; }
+fi
+
+# Optional in-process extension for the GUI; the executables are enough without it
+python3 setup.py build_ext --inplace > /dev/null 2>&1 || echo "Python extension _shahash not built; the GUI will use the executables"
+
+echo
+echo "All executables compiled successfully!"
+echo "Optimization flags: $CXXFLAGS"
@@ -0,0 +1,76 @@
+@echo off
+rem Profile-guided + link-time optimised build
+rem   1. plain -O3 build, time the shipped executables as the baseline
+rem   2. instrumented build, run bench\pgo_train.py over it
+rem   3. rebuild with -fprofile-use -flto, time them again and report the speedup
+rem The benchmarks are built once with plain -O3; they are not part of the
+rem profile or the report.
+setlocal
+
+set PGO_DIR=pgo
+set PROFILE_DIR=%CD%\%PGO_DIR%\profile
+set BASE_FLAGS=-O3
+
+if not exist bin mkdir bin
+if exist %PGO_DIR% rmdir /s /q %PGO_DIR%
+mkdir %PROFILE_DIR%
+
+for %%n in (KernelBench FileBench) do (
+    g++ %BASE_FLAGS% -pthread -o bin/%%n.exe bench/%%n.cpp
+    if errorlevel 1 (
+        echo Error compiling %%n.cpp
+        exit /b 1
+    )
+)
+
+echo [1/3] Baseline build...
+call :build "%BASE_FLAGS%"
+if %errorlevel% neq 0 exit /b %errorlevel%
+python bench\pgo_train.py measure bin %PGO_DIR%\before.csv
+if %errorlevel% neq 0 (
+    echo Baseline measurement failed
+    exit /b %errorlevel%
+)
+
+echo [2/3] Instrumented build and training run...
+call :build "%BASE_FLAGS% -fprofile-generate -fprofile-update=atomic -fprofile-dir=%PROFILE_DIR%"
+if %errorlevel% neq 0 exit /b %errorlevel%
+python bench\pgo_train.py train bin
+if %errorlevel% neq 0 (
+    echo Training run failed
+    exit /b %errorlevel%
+)
+
+echo [3/3] Optimised build (-fprofile-use -flto)...
+rem Output paths must match the instrumented build so each binary finds its profile
+call :build "%BASE_FLAGS% -flto -fprofile-use -fprofile-correction -fprofile-dir=%PROFILE_DIR%"
+if %errorlevel% neq 0 exit /b %errorlevel%
+python bench\pgo_train.py measure bin %PGO_DIR%\after.csv
+if %errorlevel% neq 0 (
+    echo Measurement failed
+    exit /b %errorlevel%
+)
+
+echo.
+python bench\pgo_train.py compare %PGO_DIR%\before.csv %PGO_DIR%\after.csv
+
+echo.
+echo All executables compiled successfully!
+echo Optimization flags: %BASE_FLAGS% -flto -fprofile-use
+exit /b 0
+
+rem The executables users run
+:build
+for %%n in (Sha224 Sha256 Sha384 Sha512 Sha512_224 Sha512_256 Crc Md5 Sha1) do (
+    g++ %~1 -o bin/%%n.exe src/%%n.cpp
+    if errorlevel 1 (
+        echo Error compiling %%n.cpp
+        exit /b 1
+    )
+)
+g++ %~1 -pthread -o bin/HashEngine.exe src/HashEngine.cpp
+if errorlevel 1 (
+    echo Error compiling HashEngine.cpp
+    exit /b 1
+)
+exit /b 0
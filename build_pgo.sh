@@ -0,0 +1,48 @@
+#!/bin/sh
+# Profile-guided + link-time optimised build (POSIX counterpart of build_pgo.bat)
+#   1. plain -O3 build, time the shipped executables as the baseline
+#   2. instrumented build, run bench/pgo_train.py over it
+#   3. rebuild with -fprofile-use -flto, time them again and report the speedup
+# The benchmarks are built once with plain -O3; they are not part of the
+# profile or the report.
+set -e
+
+PGO_DIR=pgo
+PROFILE_DIR=$PWD/$PGO_DIR/profile
+BASE_FLAGS="-O3"
+
+# The executables users run
+build() {
+    for name in Sha224 Sha256 Sha384 Sha512 Sha512_224 Sha512_256 Crc Md5 Sha1; do
+        g++ $1 -o bin/$name.exe src/$name.cpp || { echo "Error compiling $name.cpp"; exit 1; }
+    done
+    g++ $1 -pthread -o bin/HashEngine.exe src/HashEngine.cpp || { echo "Error compiling HashEngine.cpp"; exit 1; }
+}
+
+mkdir -p bin
+rm -rf $PGO_DIR
+mkdir -p $PROFILE_DIR
+
+for name in KernelBench FileBench; do
+    g++ $BASE_FLAGS -pthread -o bin/$name.exe bench/$name.cpp || { echo "Error compiling $name.cpp"; exit 1; }
+done
+
+echo "[1/3] Baseline build..."
+build "$BASE_FLAGS"
+python3 bench/pgo_train.py measure bin $PGO_DIR/before.csv
+
+echo "[2/3] Instrumented build and training run..."
+build "$BASE_FLAGS -fprofile-generate -fprofile-update=atomic -fprofile-dir=$PROFILE_DIR"
+python3 bench/pgo_train.py train bin
+
+echo "[3/3] Optimised build (-fprofile-use -flto)..."
+# Output paths must match the instrumented build so each binary finds its profile
+build "$BASE_FLAGS -flto -fprofile-use -fprofile-correction -fprofile-dir=$PROFILE_DIR"
+python3 bench/pgo_train.py measure bin $PGO_DIR/after.csv
+
+echo
+python3 bench/pgo_train.py compare $PGO_DIR/before.csv $PGO_DIR/after.csv
+
+echo
+echo "All executables compiled successfully!"
+echo "Optimization flags: $BASE_FLAGS -flto -fprofile-use"
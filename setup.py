@@ -0,0 +1,38 @@
+"""
+Builds the _shahash CPython extension (src/_shahash.cpp) next to app/hasher.py,
+from the same headers as the native executables:
+
+    python setup.py build_ext --inplace
+    python setup.py build_ext --inplace --compiler=mingw32   (Windows)
+
+The kernels use GCC/Clang builtins, intrinsics and attributes, so MSVC cannot
+build them; on Windows use MinGW-w64, as build.bat does. app/hasher.py uses
+the extension when present and falls back to the executables otherwise.
+"""
+
+from setuptools import setup, Extension
+from setuptools.command.build_ext import build_ext
+
+
+class BuildExt(build_ext):
+    """Pass optimisation and C++17 flags; GCC-compatible compilers only."""
+
+    def build_extensions(self):
+        if self.compiler.compiler_type == 'msvc':
+            raise SystemExit('_shahash needs GCC or Clang (GNU builtins and target attributes); '
+                             'on Windows build with MinGW-w64: python setup.py build_ext --inplace --compiler=mingw32')
+        for extension in self.extensions:
+            extension.extra_compile_args = ['-O3', '-std=c++17']
+        super().build_extensions()
+
+
+setup(
+    name='shahash',
+    version='1.0',
+    description='Native hash kernels of the Hashing-Algorithm engine',
+    ext_modules=[
+        # The dotted name makes --inplace put the module in app/
+        Extension('app._shahash', sources=['src/_shahash.cpp'], include_dirs=['src'], language='c++'),
+    ],
+    cmdclass={'build_ext': BuildExt},
+)
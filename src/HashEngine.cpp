@@ -0,0 +1,628 @@
+// Multi-algorithm native hashing engine.
+//
+//   HashEngine --algo SHA-256,MD5 [SIZE] [--progress] [--perf] [--trace FILE] [--metrics FILE]
+//                    [--ring MEMFD:DATAFD:SPACEFD[:PID]] [--fanout] [--fused] [--midstate] [--resume FILE]
+//       Hash stdin once with every listed algorithm; prints "<name> <hex>" per line.
+//       --ring reads a shared-memory ring instead of stdin, see shm_ring.h.
+//       --fanout hashes each algorithm on its own thread, fed by one reader
+//       through a lock-free ring (fanout_ring.h).
+//       --fused runs every algorithm over each 8 KiB tile of a buffer in
+//       turn, while it is in L1 (single-core hosts, see fusedUpdate).
+//       SIGTERM / SIGINT stop hashing within one buffer and print
+//       "CANCELLED <bytes>"; --midstate adds the per-algorithm midstates and
+//       --resume continues from them (cancel_token.h).
+//       SIZE or --progress turns on PROGRESS records on stderr (see common.h).
+//       --perf wraps read / transform / finalize in hardware counters and
+//       prints per-stage cycles/byte and IPC to stderr as one JSON line.
+//       --trace writes per-buffer read / hash / finalize / output spans as
+//       Chrome Trace Event JSON (open in Perfetto, see trace.h).
+//       --metrics keeps a live snapshot (bytes per algorithm, throughput,
+//       kernel backends) in FILE while hashing, see live_metrics.h.
+//   HashEngine --serve
+//       Persistent request loop for short inputs. Each request on stdin is a
+//       header line "HASH <length> <algo>[,<algo>...]" followed by <length>
+//       raw bytes; the reply is one line of space-separated hex digests in
+//       request order, or "ERROR <message>".
+//   HashEngine --latency [ITERATIONS]
+//       In-process time-to-digest for 0 B - 4 KiB inputs, CSV on stdout.
+//   HashEngine --cpu-features
+//       Detected CPU features and the kernel variant each algorithm selected.
+//   HashEngine --tune
+//       Calibrate kernel variants, buffer size and thread count on this host
+//       and write the tuning profile every executable loads (see tuning.h).
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <thread>
+#include <filesystem>
+#include "buffer_pool.h"
+#include "cancel_token.h"
+#include "common.h"
+#include "fanout_ring.h"
+#include "hash_registry.h"
+#include "file_reader.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "live_metrics.h"
+
+using namespace std;
+
+vector<string> splitNames(const string& text) {
+    vector<string> names;
+    stringstream ss(text);
+    string name;
+    while (getline(ss, name, ',')) {
+        if (!name.empty()) names.push_back(name);
+    }
+    return names;
+}
+
+// Build hashers for a comma-separated list; empty on unknown names
+vector<unique_ptr<DynamicHasher>> createHashers(const string& list, string& error) {
+    vector<unique_ptr<DynamicHasher>> hashers;
+    for (const string& name : splitNames(list)) {
+        unique_ptr<DynamicHasher> hasher = createHasher(name);
+        if (!hasher) {
+            error = "Unknown algorithm: " + name;
+            return {};
+        }
+        hashers.push_back(move(hasher));
+    }
+    if (hashers.empty()) error = "No algorithm given";
+    return hashers;
+}
+
+// Buffers in flight between the fan-out reader and the slowest algorithm
+constexpr size_t FANOUT_SLOTS = 4;
+
+int runHashStdin(const string& algorithms, const ProgressOptions& progressOptions, bool perf, const string& tracePath,
+                 const string& metricsPath, const string& ringSpec, bool fanout, bool fused,
+                 const CancelOptions& cancelOptions) {
+    initBinaryMode();
+    installCancelHandlers();
+    if (fanout && perf) {
+        // The counters follow the reading thread, which no longer hashes
+        cerr << "--perf cannot be combined with --fanout" << endl;
+        return 1;
+    }
+    if (fanout && fused) {
+        cerr << "--fused cannot be combined with --fanout" << endl;
+        return 1;
+    }
+    if (!tracePath.empty()) {
+        startTracing();
+        traceThreadName("engine");
+    }
+
+    string error;
+    vector<unique_ptr<DynamicHasher>> hashers = createHashers(algorithms, error);
+    if (hashers.empty()) {
+        cerr << error << endl;
+        return 1;
+    }
+
+    uint64_t totalBytes = 0;
+    if (!cancelOptions.resumePath.empty()) {
+        ResumePoint point;
+        if (!readResumePoint(cancelOptions.resumePath, point, error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        for (auto& hasher : hashers) {
+            const string* state = point.state(hasher->name());
+            if (!state || !hasher->loadState(*state)) {
+                cerr << "No usable " << hasher->name() << " midstate in " << cancelOptions.resumePath << endl;
+                return 1;
+            }
+        }
+        totalBytes = point.bytes;
+    }
+
+    ShmRingReader ring;
+    if (!ringSpec.empty() && !ring.open(ringSpec, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+
+    LiveMetrics metrics;
+    if (!metricsPath.empty()) {
+        if (!metrics.open(metricsPath, error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        for (auto& hasher : hashers) metrics.addAlgorithm(hasher->name(), hasher->backend());
+        metrics.setInputBackend(ring.active() ? "ring" : "stdin");
+        metrics.filesQueued(1);
+        metrics.start();
+        metrics.fileStarted();
+    }
+
+    size_t bufferSize = tunedBufferSize();
+
+    // Stages: read, then transform and finalize per algorithm
+    unique_ptr<StageProfiler> profiler;
+    size_t readStage = 0;
+    vector<size_t> transformStages, finalizeStages;
+    if (perf) {
+        profiler.reset(new StageProfiler());
+        readStage = profiler->addStage("read");
+        // Fused tiles interleave the algorithms, so they share one transform stage
+        size_t fusedStage = fused ? profiler->addStage("transform:fused") : 0;
+        for (auto& hasher : hashers) {
+            transformStages.push_back(fused ? fusedStage : profiler->addStage(string("transform:") + hasher->name()));
+            finalizeStages.push_back(profiler->addStage(string("finalize:") + hasher->name()));
+        }
+        profiler->begin();
+    }
+
+    ProgressReporter progress(progressOptions.enabled, progressOptions.totalBytes, totalBytes);
+
+    // Fan-out: this thread only reads; each algorithm hashes on its own thread
+    unique_ptr<FanoutRing> fanoutRing;
+    vector<thread> workers;
+    // With one CPU the threads would only take turns (measured ~6% slower)
+    if (fanout && hashers.size() > 1 && thread::hardware_concurrency() > 1) {
+        fanoutRing.reset(new FanoutRing(FANOUT_SLOTS, bufferSize, hashers.size()));
+        bufferSize = fanoutRing->slotSize();
+        for (size_t i = 0; i < hashers.size(); ++i) {
+            workers.emplace_back([&, i]() {
+                if (tracingEnabled()) traceThreadName(string("hash-") + hashers[i]->name());
+                const uint8_t* data;
+                size_t length;
+                while (fanoutRing->next(i, data, length)) {
+                    {
+                        TraceSpan span("hash", hashers[i]->name(), length);
+                        hashers[i]->update(data, length);
+                    }
+                    metrics.addAlgorithmBytes(i, length);
+                    fanoutRing->release(i);
+                }
+            });
+        }
+    }
+    // Otherwise stdin is read into one buffer from the shared pool
+    PooledBuffer buffer;
+    if (!ring.active() && !fanoutRing) {
+        buffer = sharedBufferPool().acquire(bufferSize);
+        bufferSize = min(bufferSize, buffer.size());
+    }
+
+    uint64_t traceStart = tracingEnabled() ? traceNow() : 0;
+    bool readFailed = false;
+    bool cancelled = false;
+    while (!cancelled) {
+        // Also before each read: a cancel that arrived while hashing would
+        // otherwise wait for more input first
+        if (cancelRequested()) {
+            cancelled = true;
+            break;
+        }
+        uint8_t* target = fanoutRing ? fanoutRing->acquire() : buffer.data();
+        const uint8_t* data = target;
+        size_t bytesRead;
+        {
+            TraceSpan span("read_wait");
+            if (ring.active()) {
+                readFailed = !ring.next(bufferSize, data, bytesRead, error);
+                if (readFailed) bytesRead = 0;
+                if (fanoutRing && bytesRead) {
+                    // Slots outlive the ring span, which goes back to the producer now
+                    memcpy(target, data, bytesRead);
+                    ring.release();
+                    data = target;
+                }
+            } else {
+                cin.read((char*)target, bufferSize);
+                bytesRead = cin.gcount();
+                // cin is synced with stdio, whose read errors only show in ferror;
+                // a read interrupted by a cancel is not an error
+                readFailed = (cin.bad() || ferror(stdin)) && !cancelRequested();
+                if (readFailed) error = string("Error reading standard input: ") + strerror(errno);
+            }
+            span.setBytes(bytesRead);
+        }
+        if (profiler) profiler->mark(readStage, bytesRead);
+        // What was read before a cancel is still hashed, so the midstates cover it
+        cancelled = cancelRequested();
+        if (bytesRead == 0) break;
+        metrics.addInputBytes(bytesRead);
+
+        if (fanoutRing) {
+            fanoutRing->publish(bytesRead);
+        } else if (fused) {
+            {
+                TraceSpan span("hash", "fused", bytesRead);
+                fusedUpdate(hashers, data, bytesRead);
+            }
+            if (profiler) profiler->mark(transformStages[0], bytesRead);
+            for (size_t i = 0; i < hashers.size(); ++i) metrics.addAlgorithmBytes(i, bytesRead);
+            ring.release();
+        } else {
+            for (size_t i = 0; i < hashers.size(); ++i) {
+                TraceSpan span("hash", hashers[i]->name(), bytesRead);
+                hashers[i]->update(data, bytesRead);
+                if (profiler) profiler->mark(transformStages[i], bytesRead);
+                metrics.addAlgorithmBytes(i, bytesRead);
+            }
+            ring.release();
+        }
+        totalBytes += bytesRead;
+        progress.update(totalBytes);
+    }
+    if (fanoutRing) {
+        fanoutRing->finish();
+        for (thread& worker : workers) worker.join();
+    }
+    progress.finish(totalBytes);
+    if (readFailed) {
+        cerr << error << endl;
+        if (metrics.active()) {
+            metrics.fileFinished(false);
+            metrics.stop();
+        }
+        return 1;
+    }
+
+    if (cancelled) {
+        cout << "CANCELLED " << totalBytes << '\n';
+        if (cancelOptions.midstate) {
+            for (auto& hasher : hashers) cout << "MIDSTATE " << hasher->name() << ' ' << hasher->saveState() << '\n';
+        }
+        cout.flush();
+        if (metrics.active()) {
+            metrics.fileFinished(false);
+            metrics.stop();
+        }
+        return EXIT_CANCELLED;
+    }
+
+    vector<string> digests;
+    for (size_t i = 0; i < hashers.size(); ++i) {
+        if (profiler) profiler->begin();   // Progress output is not a stage
+        TraceSpan span("finalize", hashers[i]->name());
+        digests.push_back(hashers[i]->hexdigest());
+        if (profiler) profiler->mark(finalizeStages[i], totalBytes);
+    }
+
+    {
+        TraceSpan span("output");
+        for (size_t i = 0; i < hashers.size(); ++i) {
+            cout << hashers[i]->name() << ' ' << digests[i] << '\n';
+        }
+        cout.flush();
+    }
+    if (metrics.active()) {
+        metrics.fileFinished(true);
+        metrics.stop();
+    }
+
+    if (profiler) {
+        fprintf(stderr, "%s\n", profiler->json().c_str());
+        fflush(stderr);
+    }
+    if (!tracePath.empty()) {
+        traceEvent("file", nullptr, traceStart, traceNow(), totalBytes);
+        if (!writeChromeTrace(tracePath)) {
+            cerr << "Cannot write trace " << tracePath << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Payload read size for --serve; the request length never sizes an allocation
+constexpr size_t SERVE_CHUNK_SIZE = 64 * 1024;
+
+// Request loop; stdio is used directly so each reply is one write + flush
+int runServe() {
+    initBinaryMode();
+
+    PooledBuffer chunk = sharedBufferPool().acquire(SERVE_CHUNK_SIZE);
+    char header[512];
+
+    while (fgets(header, sizeof(header), stdin)) {
+        char command[16] = {0};
+        unsigned long long length = 0;
+        char algorithms[448] = {0};
+        if (sscanf(header, "%15s %llu %447s", command, &length, algorithms) != 3 || strcmp(command, "HASH") != 0) {
+            fputs("ERROR malformed request\n", stdout);
+            fflush(stdout);
+            continue;
+        }
+
+        // Hashed as it arrives; an unknown algorithm still consumes the payload
+        // so the next header is read from the right place
+        string error;
+        vector<unique_ptr<DynamicHasher>> hashers = createHashers(algorithms, error);
+        unsigned long long remaining = length;
+        while (remaining > 0) {
+            size_t count = (size_t)min<unsigned long long>(remaining, chunk.size());
+            if (fread(chunk.data(), 1, count, stdin) != count) return 0;   // Caller went away mid-request
+            for (auto& hasher : hashers) hasher->update(chunk.data(), count);
+            remaining -= count;
+        }
+        if (hashers.empty()) {
+            fprintf(stdout, "ERROR %s\n", error.c_str());
+            fflush(stdout);
+            continue;
+        }
+
+        string reply;
+        for (auto& hasher : hashers) {
+            if (!reply.empty()) reply += ' ';
+            reply += hasher->hexdigest();
+        }
+        reply += '\n';
+        fwrite(reply.data(), 1, reply.size(), stdout);
+        fflush(stdout);
+    }
+    return 0;
+}
+
+// In-process latency: create, update, finalize, format - the same work a request does
+int runLatency(int iterations) {
+    const size_t SIZES[] = {0, 16, 64, 256, 1024, 4096};
+    vector<uint8_t> input(4096);
+    for (size_t i = 0; i < input.size(); ++i) input[i] = (uint8_t)(i * 131 + 7);
+
+    cout << "algorithm,size,iterations,p50_us,p99_us" << endl;
+    for (const AlgorithmInfo& info : allAlgorithms()) {
+        for (size_t size : SIZES) {
+            vector<double> samples;
+            samples.reserve(iterations);
+            for (int i = 0; i < iterations; ++i) {
+                auto start = chrono::steady_clock::now();
+                unique_ptr<DynamicHasher> hasher = info.create();
+                hasher->update(input.data(), size);
+                string digest = hasher->hexdigest();
+                samples.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+            }
+            sort(samples.begin(), samples.end());
+            cout << info.name << ',' << size << ',' << iterations << ','
+                 << fixed << setprecision(3) << samples[samples.size() / 2] << ','
+                 << samples[min(samples.size() - 1, samples.size() * 99 / 100)] << endl;
+            cout.unsetf(ios::fixed);
+        }
+    }
+    return 0;
+}
+
+// "<algorithm> <backend>" per algorithm, after the CPU feature line
+int runCpuFeatures() {
+    cout << "cpu " << describeCpuFeatures() << endl;
+    for (const AlgorithmInfo& info : allAlgorithms()) {
+        unique_ptr<DynamicHasher> hasher = info.create();
+        cout << info.name << ' ' << hasher->backend() << endl;
+    }
+    return 0;
+}
+
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Fastest supported variant of one kernel family on a 1 MiB message
+string tuneKernel(KernelSelector& kernels, const AlgorithmInfo& info, const vector<uint8_t>& message) {
+    string best;
+    double bestSeconds = INFINITY;
+    for (const char* variant : kernels.supportedVariants()) {
+        kernels.select(variant);
+        unique_ptr<DynamicHasher> hasher = info.create();
+        uint8_t digest[64];
+        for (int repeat = 0; repeat < 5; ++repeat) {
+            auto start = chrono::steady_clock::now();
+            hasher->reset();
+            hasher->update(message.data(), message.size());
+            hasher->finalize(digest);
+            double seconds = secondsSince(start);
+            if (seconds < bestSeconds) {
+                bestSeconds = seconds;
+                best = variant;
+            }
+        }
+    }
+    kernels.select(best.c_str());
+    return best;
+}
+
+// Buffer size for streaming a file through a pipe into a hasher, the way the
+// GUI feeds the executables. The smallest size within 5% of the best wins.
+size_t tuneBufferSize(const string& scratchDir) {
+    const size_t FILE_SIZE = 64 * 1024 * 1024;
+    const size_t CANDIDATES[] = {64 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024, 16 * 1024 * 1024};
+
+    auto stamp = chrono::steady_clock::now().time_since_epoch().count();
+    string path = scratchDir + "/hashengine_tune_" + to_string((long long)stamp) + ".bin";
+    {
+        vector<uint8_t> chunk(1024 * 1024);
+        for (size_t i = 0; i < chunk.size(); ++i) chunk[i] = (uint8_t)(i * 2654435761u >> 13);
+        ofstream out(path, ios::binary);
+        for (size_t written = 0; written < FILE_SIZE; written += chunk.size()) {
+            out.write((const char*)chunk.data(), chunk.size());
+        }
+        if (!out) return DEFAULT_BUFFER_SIZE;
+    }
+
+    vector<string> backends = availableReadBackends();
+    string backend = find(backends.begin(), backends.end(), "pipe") != backends.end() ? "pipe" : "read";
+
+    vector<double> rates;
+    for (size_t bufferSize : CANDIDATES) {
+        double best = 0;
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            unique_ptr<DynamicHasher> hasher = createHasher("SHA-256");
+            string error;
+            auto start = chrono::steady_clock::now();
+            readFile(backend, path, bufferSize, [&](const uint8_t* data, size_t length) {
+                hasher->update(data, length);
+            }, error);
+            best = max(best, FILE_SIZE / secondsSince(start));
+        }
+        rates.push_back(best);
+    }
+    remove(path.c_str());
+
+    double fastest = *max_element(rates.begin(), rates.end());
+    for (size_t i = 0; i < rates.size(); ++i) {
+        if (rates[i] >= fastest * 0.95) return CANDIDATES[i];
+    }
+    return DEFAULT_BUFFER_SIZE;
+}
+
+// Worker count past which another thread adds less than half a thread's
+// throughput (SMT siblings, shared memory bandwidth, thermal limits)
+int tuneThreads(const vector<uint8_t>& message) {
+    const int MESSAGES_PER_THREAD = 8;
+    int maxThreads = (int)min(32u, max(1u, thread::hardware_concurrency()));
+
+    double singleRate = 0;
+    double previousRate = 0;
+    int knee = 1;
+    for (int threads = 1; threads <= maxThreads; ++threads) {
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&]() {
+                unique_ptr<DynamicHasher> hasher = createHasher("SHA-256");
+                for (int i = 0; i < MESSAGES_PER_THREAD; ++i) {
+                    hasher->update(message.data(), message.size());
+                }
+                hasher->hexdigest();
+            });
+        }
+        for (thread& worker : workers) worker.join();
+        double rate = (double)message.size() * MESSAGES_PER_THREAD * threads / secondsSince(start);
+
+        if (threads == 1) {
+            singleRate = rate;
+        } else if (rate - previousRate < singleRate * 0.5) {
+            break;
+        }
+        knee = threads;
+        previousRate = rate;
+    }
+    return knee;
+}
+
+int runTune() {
+    vector<uint8_t> message(1024 * 1024);
+    for (size_t i = 0; i < message.size(); ++i) message[i] = (uint8_t)(i * 131 + 7);
+
+    TuningProfile profile;
+    profile.host = tuningHostName();
+    profile.cpu = describeCpuFeatures();
+
+    for (const AlgorithmInfo& info : allAlgorithms()) {
+        KernelSelector& kernels = info.kernels();
+        if (profile.kernels.count(kernels.name())) continue;   // Family already tuned
+        profile.kernels[kernels.name()] = tuneKernel(kernels, info, message);
+    }
+
+    error_code ignored;
+    profile.bufferSize = tuneBufferSize(filesystem::temp_directory_path(ignored).string());
+    profile.threads = tuneThreads(message);
+
+    string path = tuningProfilePath();
+    if (!writeTuningProfile(path, profile)) {
+        cerr << "Cannot write tuning profile: " << path << endl;
+        return 1;
+    }
+
+    cout << "profile " << path << '\n'
+         << "cpu " << profile.cpu << '\n'
+         << "buffer_size " << profile.bufferSize << '\n'
+         << "threads " << profile.threads << '\n';
+    for (const auto& entry : profile.kernels) {
+        cout << "kernel " << entry.first << ' ' << entry.second << '\n';
+    }
+    cout.flush();
+    return 0;
+}
+
+void printUsage() {
+    cerr << "Usage: HashEngine --algo NAME[,NAME...] [SIZE] [--progress] [--perf] [--trace FILE] [--metrics FILE] [--ring MEMFD:DATAFD:SPACEFD[:PID]] [--fanout] [--fused] [--midstate] [--resume FILE] | --serve | --latency [ITERATIONS] | --cpu-features | --tune" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "--tune") {
+        return runTune();
+    }
+    applyTunedKernels();
+
+    if (mode == "--serve") {
+        return runServe();
+    }
+    if (mode == "--cpu-features") {
+        return runCpuFeatures();
+    }
+    if (mode == "--latency") {
+        int iterations = argc > 2 ? atoi(argv[2]) : 10000;
+        return runLatency(max(1, iterations));
+    }
+    if (mode == "--algo" && argc > 2) {
+        bool perf = false;
+        string tracePath, metricsPath, ringSpec;
+        bool fanout = false;
+        bool fused = false;
+        CancelOptions cancelOptions;
+        ProgressOptions progress;
+        for (int i = 3; i < argc; ++i) {
+            if (strcmp(argv[i], "--perf") == 0) {
+                perf = true;
+                continue;
+            }
+            if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+                tracePath = argv[++i];
+                continue;
+            }
+            if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+                metricsPath = argv[++i];
+                continue;
+            }
+            if (strcmp(argv[i], "--fanout") == 0) {
+                fanout = true;
+                continue;
+            }
+            if (strcmp(argv[i], "--fused") == 0) {
+                fused = true;
+                continue;
+            }
+            if (strcmp(argv[i], "--midstate") == 0) {
+                cancelOptions.midstate = true;
+                continue;
+            }
+            if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+                cancelOptions.resumePath = argv[++i];
+                continue;
+            }
+            if (strcmp(argv[i], "--ring") == 0 && i + 1 < argc) {
+                ringSpec = argv[++i];
+                continue;
+            }
+            // A mistyped flag (or a flag missing its value) must not turn
+            // into a plain hash
+            if (!parseProgressArgument(argv[i], progress)) {
+                cerr << "Unknown or incomplete argument: " << argv[i] << endl;
+                printUsage();
+                return 1;
+            }
+        }
+        return runHashStdin(argv[2], progress, perf, tracePath, metricsPath, ringSpec, fanout, fused, cancelOptions);
+    }
+
+    printUsage();
+    return 1;
+}
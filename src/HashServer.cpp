@@ -0,0 +1,259 @@
+// Asynchronous hashing server for many concurrent, slow uploads (Linux).
+//
+//   HashServer --listen [HOST:]PORT [--threads N]
+//
+// Each TCP connection is one stream: a header line "HASH <algo>[,<algo>...]"
+// followed by the raw bytes, ended by the client shutting down its sending
+// side. The reply is one line of space-separated hex digests in request
+// order, or "ERROR <message>", then the connection is closed.
+//
+// Every connection is a coroutine on a few executor threads (async_engine.h)
+// rather than a thread of its own; a suspended stream keeps only its hasher
+// states. Prints "LISTENING <port>" on stdout once it accepts connections
+// (port 0 picks a free one). HOST defaults to 127.0.0.1; --threads defaults
+// to the tuned thread count, else one per CPU.
+//
+//   g++ -O3 -std=c++20 -pthread -o bin/HashServer.exe src/HashServer.cpp
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <memory>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "async_engine.h"
+#include "buffer_pool.h"
+#include "hash_registry.h"
+#include "tuning.h"
+
+using namespace std;
+
+constexpr size_t HEADER_LIMIT = 512;
+// Read size, one buffer per executor thread from the shared pool
+constexpr size_t STREAM_READ_SIZE = 64 * 1024;
+// Reads before a busy stream goes back through epoll so the others get a turn
+constexpr int READS_PER_TURN = 16;
+// Pause before accepting again when out of file descriptors
+constexpr int ACCEPT_BACKOFF_MS = 50;
+
+// Valid until the coroutine next suspends; it may resume on another thread
+static uint8_t* threadBuffer() {
+    thread_local PooledBuffer buffer = sharedBufferPool().acquire(STREAM_READ_SIZE);
+    return buffer.data();
+}
+
+static vector<unique_ptr<DynamicHasher>> createHashers(const string& list, string& error) {
+    vector<unique_ptr<DynamicHasher>> hashers;
+    stringstream ss(list);
+    string name;
+    while (getline(ss, name, ',')) {
+        if (name.empty()) continue;
+        unique_ptr<DynamicHasher> hasher = createHasher(name);
+        if (!hasher) {
+            error = "Unknown algorithm: " + name;
+            return {};
+        }
+        hashers.push_back(move(hasher));
+    }
+    if (hashers.empty() && error.empty()) error = "No algorithm given";
+    return hashers;
+}
+
+static AsyncTask hashStream(EpollExecutor& executor, int fd) {
+    AsyncSocket socket(executor, fd);
+
+    // Header line; whatever follows it in the same read is payload
+    char header[HEADER_LIMIT];
+    size_t headerLength = 0;
+    char* newline = nullptr;
+    while (!newline) {
+        if (headerLength == HEADER_LIMIT) break;
+        ssize_t count = read(fd, header + headerLength, HEADER_LIMIT - headerLength);
+        if (count > 0) {
+            newline = (char*)memchr(header + headerLength, '\n', count);
+            headerLength += count;
+            continue;
+        }
+        if (count == 0) break;
+        if (errno == EINTR) continue;
+        if ((errno != EAGAIN && errno != EWOULDBLOCK) || !co_await socket.readable()) co_return;
+    }
+
+    string error;
+    vector<unique_ptr<DynamicHasher>> hashers;
+    if (newline) {
+        string line(header, newline - header);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.compare(0, 5, "HASH ") == 0) {
+            hashers = createHashers(line.substr(5), error);
+        } else {
+            error = "malformed request";
+        }
+    } else {
+        error = "malformed request";
+    }
+
+    string reply;
+    if (hashers.empty()) {
+        // Replied without draining the upload; the client sees the reply or a reset
+        reply = "ERROR " + error + "\n";
+    } else {
+        size_t leftover = header + headerLength - (newline + 1);
+        for (auto& hasher : hashers) hasher->update((const uint8_t*)newline + 1, leftover);
+
+        // Payload: hash whatever is buffered, suspend when the socket runs dry
+        bool ended = false;
+        while (!ended) {
+            bool idle = false;
+            for (int turn = 0; turn < READS_PER_TURN && !ended && !idle; ++turn) {
+                uint8_t* buffer = threadBuffer();
+                ssize_t count = read(fd, buffer, STREAM_READ_SIZE);
+                if (count > 0) {
+                    for (auto& hasher : hashers) hasher->update(buffer, count);
+                } else if (count == 0) {
+                    ended = true;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    idle = true;
+                } else if (errno != EINTR) {
+                    co_return;   // Connection reset
+                }
+            }
+            if (!ended && !co_await socket.readable()) co_return;
+        }
+
+        for (auto& hasher : hashers) {
+            if (!reply.empty()) reply += ' ';
+            reply += hasher->hexdigest();
+        }
+        reply += '\n';
+    }
+
+    size_t offset = 0;
+    while (offset < reply.size()) {
+        ssize_t written = send(fd, reply.data() + offset, reply.size() - offset, MSG_NOSIGNAL);
+        if (written >= 0) {
+            offset += written;
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if ((errno != EAGAIN && errno != EWOULDBLOCK) || !co_await socket.writable()) co_return;
+    }
+}
+
+// backoffFd is a timerfd made up front: once descriptors run out it could not be.
+// A fatal error stops the executor, so the server exits instead of running
+// on without a listener.
+static AsyncTask acceptConnections(EpollExecutor& executor, int listenFd, int backoffFd) {
+    AsyncSocket listener(executor, listenFd);
+    AsyncTimer backoff(executor, backoffFd);
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0) {
+            hashStream(executor, fd);   // Runs until its first suspension, then on the executor
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (!co_await listener.readable()) break;
+        } else if (errno == EMFILE || errno == ENFILE) {
+            // Out of descriptors: back off instead of spinning on the ready
+            // listener, without holding up the streams on this thread
+            perror("accept");
+            if (!backoff.start(ACCEPT_BACKOFF_MS) || !co_await backoff.expired()) break;
+        } else if (errno != EINTR && errno != ECONNABORTED) {
+            perror("accept");
+            break;
+        }
+    }
+    cerr << "No longer accepting connections; stopping" << endl;
+    executor.stop();
+}
+
+static void printUsage() {
+    cerr << "Usage: HashServer --listen [HOST:]PORT [--threads N]   (N from 1 to " << MAX_THREADS << ")" << endl;
+}
+
+static int openListener(const string& address, sockaddr_in& bound) {
+    string host = "127.0.0.1";
+    string port = address;
+    size_t colon = address.rfind(':');
+    if (colon != string::npos) {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+    }
+
+    sockaddr_in socketAddress{};
+    socketAddress.sin_family = AF_INET;
+    unsigned long long portNumber;
+    if (!parseDecimal(port, 0, 65535, portNumber) ||
+        inet_pton(AF_INET, host.c_str(), &socketAddress.sin_addr) != 1) {
+        cerr << "Invalid listen address: " << address << endl;
+        printUsage();
+        return -1;
+    }
+    socketAddress.sin_port = htons((uint16_t)portNumber);
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(fd, (sockaddr*)&socketAddress, sizeof(socketAddress)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        perror("listen");
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    socklen_t length = sizeof(bound);
+    getsockname(fd, (sockaddr*)&bound, &length);
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    string address;
+    unsigned threads = tuningProfile().threads > 0 ? tuningProfile().threads : thread::hardware_concurrency();
+    for (int i = 1; i < argc; ++i) {
+        unsigned long long count;
+        if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+            address = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && parseDecimal(argv[i + 1], 1, MAX_THREADS, count)) {
+            threads = (unsigned)count;
+            ++i;
+        } else {
+            cerr << "Unknown, incomplete or invalid argument: " << argv[i] << endl;
+            printUsage();
+            return 1;
+        }
+    }
+    if (address.empty()) {
+        printUsage();
+        return 1;
+    }
+    threads = min(max(1u, threads), MAX_THREADS);
+
+    applyTunedKernels();
+    signal(SIGPIPE, SIG_IGN);
+
+    EpollExecutor executor;
+    if (!executor.valid()) {
+        perror("epoll_create1");
+        return 1;
+    }
+    sockaddr_in bound{};
+    int listenFd = openListener(address, bound);
+    if (listenFd < 0) return 1;
+    int backoffFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (backoffFd < 0) {
+        perror("timerfd_create");
+        close(listenFd);
+        return 1;
+    }
+
+    acceptConnections(executor, listenFd, backoffFd);
+    cout << "LISTENING " << ntohs(bound.sin_port) << endl;
+    executor.run(threads);
+    return 1;   // Only returns once accepting failed
+}
@@ -0,0 +1,7 @@
+#include "common.h"
+#include "sha2.h"
+
+// SHA-512/224: reads stdin, prints the hex digest
+int main(int argc, char* argv[]) {
+    return hashStdinMain<Sha512_224>("SHA-512/224", argc, argv);
+}
@@ -0,0 +1,366 @@
+// CPython extension exposing the native hashers in-process.
+//
+//   import _shahash
+//   h = _shahash.new("SHA-256", b"prefix")
+//   h.update(memoryview(buffer))          # any buffer-protocol object, not copied
+//   h.hexdigest()
+//   _shahash.update_all([h1, h2], chunk)  # one buffer through several algorithms
+//   c = _shahash.midstate_cache("SHA-256")
+//   c.hexdigest(text)                     # re-hashes only from the first changed block
+//
+// Hasher objects follow hashlib: digest()/hexdigest() leave the object usable,
+// copy() forks the state, and the GIL is released while hashing inputs of
+// 2 KiB or more, so several Python threads can hash at once. Each object has
+// its own mutex, making concurrent updates of one object safe (if pointless).
+//
+// Built by setup.py from the same headers as the executables.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common.h"
+#include "hash_registry.h"
+#include "midstate_cache.h"
+
+using namespace std;
+
+// Below this, releasing the GIL costs more than it saves (same as hashlib)
+constexpr Py_ssize_t GIL_MINSIZE = 2048;
+
+struct HasherObject {
+    PyObject_HEAD
+    DynamicHasher* hasher;
+    size_t blockSize;
+    mutex* lock;
+};
+
+static PyTypeObject HasherType;
+
+static HasherObject* newHasherObject(unique_ptr<DynamicHasher> hasher, size_t blockSize) {
+    HasherObject* self = PyObject_New(HasherObject, &HasherType);
+    if (!self) return nullptr;
+    self->hasher = hasher.release();
+    self->blockSize = blockSize;
+    self->lock = new mutex();
+    return self;
+}
+
+static void hasherDealloc(HasherObject* self) {
+    delete self->hasher;
+    delete self->lock;
+    PyObject_Free(self);
+}
+
+static bool isHasher(PyObject* object) {
+    return PyObject_TypeCheck(object, &HasherType);
+}
+
+// Borrow a contiguous byte view of data; str is rejected like hashlib does
+static bool getBuffer(PyObject* data, Py_buffer* view) {
+    if (PyUnicode_Check(data)) {
+        PyErr_SetString(PyExc_TypeError, "Strings must be encoded before hashing");
+        return false;
+    }
+    return PyObject_GetBuffer(data, view, PyBUF_SIMPLE) == 0;
+}
+
+// Feed one view to several distinct hashers. Locks are taken in address order
+// so two threads updating overlapping sets cannot deadlock.
+static void updateHashers(vector<HasherObject*> hashers, const Py_buffer& view) {
+    sort(hashers.begin(), hashers.end());
+
+    auto run = [&]() {
+        for (HasherObject* h : hashers) h->lock->lock();
+        for (HasherObject* h : hashers) h->hasher->update((const uint8_t*)view.buf, view.len);
+        for (HasherObject* h : hashers) h->lock->unlock();
+    };
+    if (view.len >= GIL_MINSIZE) {
+        Py_BEGIN_ALLOW_THREADS
+        run();
+        Py_END_ALLOW_THREADS
+    } else {
+        run();
+    }
+}
+
+static PyObject* hasherUpdate(HasherObject* self, PyObject* data) {
+    Py_buffer view;
+    if (!getBuffer(data, &view)) return nullptr;
+    updateHashers({self}, view);
+    PyBuffer_Release(&view);
+    Py_RETURN_NONE;
+}
+
+static vector<uint8_t> finalDigest(HasherObject* self) {
+    lock_guard<mutex> guard(*self->lock);
+    unique_ptr<DynamicHasher> finished = self->hasher->clone();
+    vector<uint8_t> digest(finished->digestSize());
+    finished->finalize(digest.data());
+    return digest;
+}
+
+static PyObject* hasherDigest(HasherObject* self, PyObject*) {
+    vector<uint8_t> digest = finalDigest(self);
+    return PyBytes_FromStringAndSize((const char*)digest.data(), digest.size());
+}
+
+static PyObject* hasherHexdigest(HasherObject* self, PyObject*) {
+    vector<uint8_t> digest = finalDigest(self);
+    string hex = toHex(digest.data(), digest.size());
+    return PyUnicode_FromStringAndSize(hex.data(), hex.size());
+}
+
+static PyObject* hasherCopy(HasherObject* self, PyObject*) {
+    unique_ptr<DynamicHasher> clone;
+    {
+        lock_guard<mutex> guard(*self->lock);
+        clone = self->hasher->clone();
+    }
+    return (PyObject*)newHasherObject(move(clone), self->blockSize);
+}
+
+static PyObject* hasherName(HasherObject* self, void*) {
+    return PyUnicode_FromString(self->hasher->name());
+}
+
+static PyObject* hasherDigestSize(HasherObject* self, void*) {
+    return PyLong_FromSize_t(self->hasher->digestSize());
+}
+
+static PyObject* hasherBlockSize(HasherObject* self, void*) {
+    return PyLong_FromSize_t(self->blockSize);
+}
+
+static PyObject* hasherBackend(HasherObject* self, void*) {
+    return PyUnicode_FromString(self->hasher->backend());
+}
+
+static PyMethodDef hasherMethods[] = {
+    {"update", (PyCFunction)hasherUpdate, METH_O, "Hash a bytes-like object; the GIL is released for large inputs."},
+    {"digest", (PyCFunction)hasherDigest, METH_NOARGS, "Digest of the data so far, as bytes."},
+    {"hexdigest", (PyCFunction)hasherHexdigest, METH_NOARGS, "Digest of the data so far, as lowercase hex."},
+    {"copy", (PyCFunction)hasherCopy, METH_NOARGS, "Independent copy of the current state."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyGetSetDef hasherGetters[] = {
+    {"name", (getter)hasherName, nullptr, "Algorithm name, as in algorithms.json.", nullptr},
+    {"digest_size", (getter)hasherDigestSize, nullptr, "Digest length in bytes.", nullptr},
+    {"block_size", (getter)hasherBlockSize, nullptr, "Kernel block size in bytes.", nullptr},
+    {"backend", (getter)hasherBackend, nullptr, "Kernel variant in use (scalar, avx2, sha-ni, ...).", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+// Digest cache for an edited buffer, see midstate_cache.h
+struct MidstateCacheObject {
+    PyObject_HEAD
+    MidstateCache* cache;
+    mutex* lock;
+};
+
+static PyTypeObject MidstateCacheType;
+
+static void cacheDealloc(MidstateCacheObject* self) {
+    delete self->cache;
+    delete self->lock;
+    PyObject_Free(self);
+}
+
+static bool cacheDigest(MidstateCacheObject* self, PyObject* data, vector<uint8_t>& digest) {
+    Py_buffer view;
+    if (!getBuffer(data, &view)) return false;
+    digest.resize(self->cache->digestSize());
+    auto run = [&]() {
+        lock_guard<mutex> guard(*self->lock);
+        self->cache->digest((const uint8_t*)view.buf, view.len, digest.data());
+    };
+    if (view.len >= GIL_MINSIZE) {
+        Py_BEGIN_ALLOW_THREADS
+        run();
+        Py_END_ALLOW_THREADS
+    } else {
+        run();
+    }
+    PyBuffer_Release(&view);
+    return true;
+}
+
+static PyObject* cacheDigestBytes(MidstateCacheObject* self, PyObject* data) {
+    vector<uint8_t> digest;
+    if (!cacheDigest(self, data, digest)) return nullptr;
+    return PyBytes_FromStringAndSize((const char*)digest.data(), digest.size());
+}
+
+static PyObject* cacheHexdigest(MidstateCacheObject* self, PyObject* data) {
+    vector<uint8_t> digest;
+    if (!cacheDigest(self, data, digest)) return nullptr;
+    string hex = toHex(digest.data(), digest.size());
+    return PyUnicode_FromStringAndSize(hex.data(), hex.size());
+}
+
+static PyObject* cacheClear(MidstateCacheObject* self, PyObject*) {
+    lock_guard<mutex> guard(*self->lock);
+    self->cache->clear();
+    Py_RETURN_NONE;
+}
+
+static PyObject* cacheName(MidstateCacheObject* self, void*) {
+    return PyUnicode_FromString(self->cache->name());
+}
+
+static PyObject* cacheDigestSize(MidstateCacheObject* self, void*) {
+    return PyLong_FromSize_t(self->cache->digestSize());
+}
+
+static PyObject* cacheResumedFrom(MidstateCacheObject* self, void*) {
+    lock_guard<mutex> guard(*self->lock);
+    return PyLong_FromSize_t(self->cache->resumedFrom());
+}
+
+static PyMethodDef cacheMethods[] = {
+    {"digest", (PyCFunction)cacheDigestBytes, METH_O, "Digest of a bytes-like object, reusing the previous call's prefix."},
+    {"hexdigest", (PyCFunction)cacheHexdigest, METH_O, "Like digest(), as lowercase hex."},
+    {"clear", (PyCFunction)cacheClear, METH_NOARGS, "Forget the previous input."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyGetSetDef cacheGetters[] = {
+    {"name", (getter)cacheName, nullptr, "Algorithm name, as in algorithms.json.", nullptr},
+    {"digest_size", (getter)cacheDigestSize, nullptr, "Digest length in bytes.", nullptr},
+    {"resumed_from", (getter)cacheResumedFrom, nullptr, "Offset the last call resumed hashing from.", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+static PyObject* moduleNew(PyObject*, PyObject* args) {
+    const char* name;
+    PyObject* data = nullptr;
+    if (!PyArg_ParseTuple(args, "s|O:new", &name, &data)) return nullptr;
+
+    for (const AlgorithmInfo& info : allAlgorithms()) {
+        if (strcmp(name, info.name) != 0) continue;
+        HasherObject* self = newHasherObject(info.create(), info.blockSize);
+        if (self && data && data != Py_None) {
+            PyObject* result = hasherUpdate(self, data);
+            if (!result) {
+                Py_DECREF(self);
+                return nullptr;
+            }
+            Py_DECREF(result);
+        }
+        return (PyObject*)self;
+    }
+    PyErr_Format(PyExc_ValueError, "Unknown algorithm: %s", name);
+    return nullptr;
+}
+
+static PyObject* moduleUpdateAll(PyObject*, PyObject* args) {
+    PyObject* sequence;
+    PyObject* data;
+    if (!PyArg_ParseTuple(args, "OO:update_all", &sequence, &data)) return nullptr;
+
+    // A tuple snapshot owns a reference to every hasher, so another thread
+    // emptying the caller's list cannot free one while the GIL is released
+    PyObject* items = PySequence_Tuple(sequence);
+    if (!items) return nullptr;
+    vector<HasherObject*> hashers;
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(items); ++i) {
+        PyObject* item = PyTuple_GET_ITEM(items, i);
+        if (!isHasher(item)) {
+            Py_DECREF(items);
+            PyErr_SetString(PyExc_TypeError, "update_all() expects _shahash hasher objects");
+            return nullptr;
+        }
+        if (find(hashers.begin(), hashers.end(), (HasherObject*)item) != hashers.end()) {
+            Py_DECREF(items);
+            PyErr_SetString(PyExc_ValueError, "update_all() got the same hasher twice");
+            return nullptr;
+        }
+        hashers.push_back((HasherObject*)item);
+    }
+
+    Py_buffer view;
+    if (!getBuffer(data, &view)) {
+        Py_DECREF(items);
+        return nullptr;
+    }
+    updateHashers(hashers, view);
+    PyBuffer_Release(&view);
+    Py_DECREF(items);
+    Py_RETURN_NONE;
+}
+
+static PyObject* moduleMidstateCache(PyObject*, PyObject* args) {
+    const char* name;
+    if (!PyArg_ParseTuple(args, "s:midstate_cache", &name)) return nullptr;
+
+    for (const AlgorithmInfo& info : allAlgorithms()) {
+        if (strcmp(name, info.name) != 0) continue;
+        MidstateCacheObject* self = PyObject_New(MidstateCacheObject, &MidstateCacheType);
+        if (!self) return nullptr;
+        self->cache = new MidstateCache(info);
+        self->lock = new mutex();
+        return (PyObject*)self;
+    }
+    PyErr_Format(PyExc_ValueError, "Unknown algorithm: %s", name);
+    return nullptr;
+}
+
+static PyObject* moduleAlgorithms(PyObject*, PyObject*) {
+    const vector<AlgorithmInfo>& algorithms = allAlgorithms();
+    PyObject* names = PyTuple_New(algorithms.size());
+    if (!names) return nullptr;
+    for (size_t i = 0; i < algorithms.size(); ++i) {
+        PyTuple_SET_ITEM(names, i, PyUnicode_FromString(algorithms[i].name));
+    }
+    return names;
+}
+
+static PyObject* moduleCpuFeatures(PyObject*, PyObject*) {
+    return PyUnicode_FromString(describeCpuFeatures().c_str());
+}
+
+static PyMethodDef moduleMethods[] = {
+    {"new", moduleNew, METH_VARARGS, "new(name, data=None) -> incremental hasher for an algorithm name."},
+    {"update_all", moduleUpdateAll, METH_VARARGS,
+     "update_all(hashers, data): feed one buffer to several distinct hashers with a single GIL release."},
+    {"midstate_cache", moduleMidstateCache, METH_VARARGS,
+     "midstate_cache(name) -> digest cache for a buffer edited between calls (e.g. a text box)."},
+    {"algorithms", moduleAlgorithms, METH_NOARGS, "Names of every available algorithm."},
+    {"cpu_features", moduleCpuFeatures, METH_NOARGS, "CPU features the kernel dispatch detected."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyModuleDef shahashModule = {
+    PyModuleDef_HEAD_INIT, "_shahash", "Native hash kernels of the Hashing-Algorithm engine.", -1, moduleMethods,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+PyMODINIT_FUNC PyInit__shahash() {
+    HasherType.tp_name = "_shahash.Hasher";
+    HasherType.tp_basicsize = sizeof(HasherObject);
+    HasherType.tp_dealloc = (destructor)hasherDealloc;
+    HasherType.tp_flags = Py_TPFLAGS_DEFAULT;
+    HasherType.tp_doc = "Incremental hasher; create with _shahash.new(name).";
+    HasherType.tp_methods = hasherMethods;
+    HasherType.tp_getset = hasherGetters;
+    if (PyType_Ready(&HasherType) < 0) return nullptr;
+
+    MidstateCacheType.tp_name = "_shahash.MidstateCache";
+    MidstateCacheType.tp_basicsize = sizeof(MidstateCacheObject);
+    MidstateCacheType.tp_dealloc = (destructor)cacheDealloc;
+    MidstateCacheType.tp_flags = Py_TPFLAGS_DEFAULT;
+    MidstateCacheType.tp_doc = "Digest cache for an edited buffer; create with _shahash.midstate_cache(name).";
+    MidstateCacheType.tp_methods = cacheMethods;
+    MidstateCacheType.tp_getset = cacheGetters;
+    if (PyType_Ready(&MidstateCacheType) < 0) return nullptr;
+
+    // Same kernel choice as the executables on this host
+    applyTunedKernels();
+
+    return PyModule_Create(&shahashModule);
+}
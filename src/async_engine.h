@@ -0,0 +1,180 @@
+#ifndef ASYNC_ENGINE_H
+#define ASYNC_ENGINE_H
+
+#include <coroutine>
+#include <exception>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Coroutine executor for many slow streams (HashServer). Each stream is a
+// coroutine that suspends while its socket has nothing to read and is resumed
+// by whichever executor thread sees the socket become ready. A stream holds
+// only its coroutine frame and hasher states; read buffers belong to the
+// executor threads, so thousands of idle uploads cost no buffer memory.
+//
+// All threads wait on one epoll instance. Sockets are armed EPOLLONESHOT: a
+// ready socket wakes exactly one thread and stays disarmed until its
+// coroutine waits again, so a stream never runs on two threads at once.
+// stop() ends run() on every thread, abandoning suspended streams.
+// Linux only; needs C++20 (-std=c++20).
+
+// Fire-and-forget coroutine: runs until its first suspension when called and
+// frees its frame when it returns
+struct AsyncTask {
+    struct promise_type {
+        AsyncTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+class EpollExecutor {
+public:
+    // Ready events taken per epoll_wait; small, so one thread does not claim
+    // the work of the idle ones
+    static constexpr int EVENT_BATCH = 16;
+
+    EpollExecutor() : epollFd(epoll_create1(EPOLL_CLOEXEC)), stopFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+        // Level-triggered with a null handle: once signalled it wakes every thread
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (epollFd >= 0 && stopFd >= 0 && epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &event) != 0) {
+            close(stopFd);
+            stopFd = -1;
+        }
+    }
+    ~EpollExecutor() {
+        if (stopFd >= 0) close(stopFd);
+        if (epollFd >= 0) close(epollFd);
+    }
+
+    EpollExecutor(const EpollExecutor&) = delete;
+    EpollExecutor& operator=(const EpollExecutor&) = delete;
+
+    bool valid() const { return epollFd >= 0 && stopFd >= 0; }
+    int fd() const { return epollFd; }
+
+    // Resume coroutines on threadCount threads, the caller being one of them
+    void run(unsigned threadCount) {
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < threadCount; ++i) threads.emplace_back([this]() { loop(); });
+        loop();
+        for (auto& thread : threads) thread.join();
+    }
+
+    // Make run() return on every thread; callable from a coroutine
+    void stop() {
+        uint64_t one = 1;
+        while (write(stopFd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+    }
+
+private:
+    void loop() {
+        epoll_event events[EVENT_BATCH];
+        for (;;) {
+            int count = epoll_wait(epollFd, events, EVENT_BATCH, -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            for (int i = 0; i < count; ++i) {
+                if (!events[i].data.ptr) return;   // stop()
+                std::coroutine_handle<>::from_address(events[i].data.ptr).resume();
+            }
+        }
+    }
+
+    int epollFd;
+    int stopFd;
+};
+
+// Non-blocking socket owned by one coroutine; closing it also removes it
+// from the epoll set
+class AsyncSocket {
+public:
+    AsyncSocket(EpollExecutor& executor, int fd) : executor(executor), socketFd(fd) {}
+    ~AsyncSocket() {
+        if (socketFd >= 0) close(socketFd);
+    }
+
+    AsyncSocket(const AsyncSocket&) = delete;
+    AsyncSocket& operator=(const AsyncSocket&) = delete;
+
+    int fd() const { return socketFd; }
+
+    // co_await socket.readable(): false if the socket could not be armed.
+    // Hang-ups and errors also resume; the next read reports them.
+    class Wait {
+    public:
+        Wait(AsyncSocket& socket, uint32_t events) : socket(socket), events(events) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            // Once armed, another thread may resume (and finish) the coroutine
+            // before this returns: no member may be touched after arm() succeeds
+            if (socket.arm(events, handle)) return true;
+            failed = true;
+            return false;
+        }
+        bool await_resume() const noexcept { return !failed; }
+
+    private:
+        AsyncSocket& socket;
+        uint32_t events;
+        bool failed = false;
+    };
+
+    Wait readable() { return Wait(*this, EPOLLIN | EPOLLRDHUP); }
+    Wait writable() { return Wait(*this, EPOLLOUT); }
+
+private:
+    bool arm(uint32_t events, std::coroutine_handle<> handle) {
+        epoll_event event{};
+        event.events = events | EPOLLONESHOT;
+        event.data.ptr = handle.address();
+        bool wasRegistered = registered;
+        // Set before the call: once it succeeds, another thread may already
+        // own (or have destroyed) this socket. A failed call resumes no one.
+        registered = true;
+        if (epoll_ctl(executor.fd(), wasRegistered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, socketFd, &event) == 0) return true;
+        registered = wasRegistered;
+        return false;
+    }
+
+    EpollExecutor& executor;
+    int socketFd;
+    bool registered = false;
+};
+
+// One-shot timer (a timerfd) owned by one coroutine; waiting on it suspends
+// the coroutine, not the executor thread
+class AsyncTimer {
+public:
+    AsyncTimer(EpollExecutor& executor, int fd) : socket(executor, fd) {}
+
+    // Restart the countdown; false if the timer could not be set
+    bool start(int milliseconds) {
+        uint64_t expirations;
+        while (read(socket.fd(), &expirations, sizeof(expirations)) > 0) {}   // Drop an earlier expiry
+        itimerspec spec{};
+        spec.it_value.tv_sec = milliseconds / 1000;
+        spec.it_value.tv_nsec = (long)(milliseconds % 1000) * 1000000;
+        return timerfd_settime(socket.fd(), 0, &spec, nullptr) == 0;
+    }
+
+    // co_await timer.expired(): false if the timer could not be armed
+    AsyncSocket::Wait expired() { return socket.readable(); }
+
+private:
+    AsyncSocket socket;
+};
+
+#endif
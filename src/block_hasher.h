@@ -0,0 +1,154 @@
+#ifndef BLOCK_HASHER_H
+#define BLOCK_HASHER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <array>
+#include <string_view>
+
+// Shared buffering and padding for Merkle-Damgard hashes (MD5, SHA-1, SHA-2).
+// Derived supplies:
+//   constexpr void resetState();
+//   constexpr void processBlocks(const uint8_t* data, size_t blockCount);
+//   constexpr void writeDigest(uint8_t* out) const;
+// Everything here is constexpr, so digests of literals can be computed at
+// compile time; at runtime whole blocks go straight to processBlocks.
+template <typename Derived, size_t BlockSize, size_t LengthSize, bool BigEndianLength, size_t DigestSize>
+class BlockHasher {
+public:
+    static constexpr size_t BLOCK_SIZE = BlockSize;
+    static constexpr size_t DIGEST_SIZE = DigestSize;
+    typedef std::array<uint8_t, DigestSize> Digest;
+
+    constexpr void reset() {
+        self().resetState();
+        bufferedBytes = 0;
+        totalBytes = 0;
+    }
+
+    constexpr void update(const uint8_t* data, size_t length) {
+        totalBytes += length;
+
+        // Top up a partially filled block first
+        if (bufferedBytes > 0) {
+            size_t take = BlockSize - bufferedBytes;
+            if (take > length) take = length;
+            copyBytes(block + bufferedBytes, data, take);
+            bufferedBytes += take;
+            data += take;
+            length -= take;
+            if (bufferedBytes < BlockSize) return;
+            self().processBlocks(block, 1);
+            bufferedBytes = 0;
+        }
+
+        // Whole blocks straight from the caller's buffer
+        size_t blockCount = length / BlockSize;
+        if (blockCount > 0) {
+            self().processBlocks(data, blockCount);
+            data += blockCount * BlockSize;
+            length -= blockCount * BlockSize;
+        }
+
+        if (length > 0) {
+            copyBytes(block, data, length);
+            bufferedBytes = length;
+        }
+    }
+
+    // Character input; byte-wise in constant evaluation, zero-copy otherwise
+    constexpr void update(const char* data, size_t length) {
+        if (!__builtin_is_constant_evaluated()) {
+            update(reinterpret_cast<const uint8_t*>(data), length);
+            return;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            uint8_t byte = static_cast<uint8_t>(data[i]);
+            update(&byte, 1);
+        }
+    }
+
+    constexpr void update(std::string_view text) {
+        update(text.data(), text.size());
+    }
+
+    // Apply padding and write the digest
+    constexpr void finalize(uint8_t* out) {
+        block[bufferedBytes] = 0x80;
+        for (size_t i = bufferedBytes + 1; i < BlockSize; ++i) {
+            block[i] = 0;
+        }
+
+        // Need two blocks if the length field no longer fits
+        if (bufferedBytes >= BlockSize - LengthSize) {
+            self().processBlocks(block, 1);
+            for (size_t i = 0; i < BlockSize; ++i) {
+                block[i] = 0;
+            }
+        }
+
+        // Message length in bits; the high word only matters for 128-bit fields
+        uint64_t lowBits = totalBytes << 3;
+        uint64_t highBits = totalBytes >> 61;
+        for (size_t i = 0; i < 8; ++i) {
+            size_t pos = BigEndianLength ? BlockSize - 1 - i : BlockSize - LengthSize + i;
+            block[pos] = (lowBits >> (i * 8)) & 0xFF;
+        }
+        if (LengthSize > 8) {
+            for (size_t i = 0; i < 8; ++i) {
+                size_t pos = BigEndianLength ? BlockSize - 9 - i : BlockSize - LengthSize + 8 + i;
+                block[pos] = (highBits >> (i * 8)) & 0xFF;
+            }
+        }
+        self().processBlocks(block, 1);
+
+        self().writeDigest(out);
+    }
+
+    constexpr Digest digest() {
+        Digest out{};
+        finalize(out.data());
+        return out;
+    }
+
+    // One-shot digest, usable in constant expressions
+    static constexpr Digest hash(std::string_view text) {
+        Derived hasher;
+        hasher.update(text);
+        return hasher.digest();
+    }
+
+    constexpr uint64_t bytesProcessed() const {
+        return totalBytes;
+    }
+
+    // Buffer position consistent with the byte count (for restored midstates)
+    constexpr bool validState() const {
+        return bufferedBytes == totalBytes % BlockSize;
+    }
+
+protected:
+    constexpr BlockHasher() {}
+
+private:
+    constexpr Derived& self() {
+        return static_cast<Derived&>(*this);
+    }
+
+    static constexpr void copyBytes(uint8_t* dst, const uint8_t* src, size_t length) {
+        if (!__builtin_is_constant_evaluated()) {
+            memcpy(dst, src, length);
+            return;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            dst[i] = src[i];
+        }
+    }
+
+    uint8_t block[BlockSize] = {};
+    size_t bufferedBytes = 0;
+    uint64_t totalBytes = 0;
+};
+
+#endif
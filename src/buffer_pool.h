@@ -0,0 +1,189 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Process-wide pool of read buffers under one memory ceiling, the native
+// counterpart of app/buffer_pool.py. Every reader that may run many times at
+// once (FileBench workers, HashServer executor threads, the HashEngine
+// fan-out ring and --serve loop) takes its buffers from sharedBufferPool(),
+// so buffer memory stays under the ceiling however many run. A reader that
+// finds the pool exhausted waits for another to give memory back
+// (back-pressure) instead of allocating more. Returned buffers are kept for
+// reuse and count against the ceiling until a request of another size needs
+// the room.
+//
+// Each holder takes everything it needs in one acquire() (several buffers
+// are slices of one block), so two holders can never each wait for the
+// other's memory. A request larger than the ceiling is cut to the ceiling;
+// PooledBuffer::size() is what was granted. Buffers are page aligned, which
+// O_DIRECT reads need.
+//
+// The ceiling is DEFAULT_MEMORY_LIMIT unless HASH_MEMORY_LIMIT is set (bytes,
+// or with a K, M or G suffix), as for the GUI.
+
+constexpr size_t DEFAULT_MEMORY_LIMIT = 256 * 1024 * 1024;
+constexpr size_t MIN_MEMORY_LIMIT = 1024 * 1024;
+constexpr size_t POOL_ALIGNMENT = 4096;
+
+class BufferPool;
+
+// One granted block; hands it back to the pool when destroyed
+class PooledBuffer {
+public:
+    PooledBuffer() {}
+    PooledBuffer(PooledBuffer&& other) noexcept { *this = std::move(other); }
+
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            std::swap(pool, other.pool);
+            std::swap(bytes, other.bytes);
+            std::swap(length, other.length);
+        }
+        return *this;
+    }
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    ~PooledBuffer() { reset(); }
+
+    uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    inline void reset();
+
+private:
+    friend class BufferPool;
+    PooledBuffer(BufferPool* pool, uint8_t* bytes, size_t length) : pool(pool), bytes(bytes), length(length) {}
+
+    BufferPool* pool = nullptr;
+    uint8_t* bytes = nullptr;
+    size_t length = 0;
+};
+
+class BufferPool {
+public:
+    explicit BufferPool(size_t limit) : ceiling(limit) {}
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    ~BufferPool() { trim(); }
+
+    size_t limit() const { return ceiling; }
+
+    // Most bytes allocated at once
+    size_t peak() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return peakBytes;
+    }
+
+    // A block of `size` bytes (at most the ceiling), waiting while the pool
+    // is exhausted
+    PooledBuffer acquire(size_t size) {
+        size = roundUp(size < ceiling ? size : ceiling);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            for (size_t i = 0; i < kept.size(); ++i) {
+                if (kept[i].second != size) continue;
+                uint8_t* bytes = kept[i].first;
+                kept.erase(kept.begin() + i);
+                return PooledBuffer(this, bytes, size);
+            }
+            if (allocated + size <= ceiling) break;
+            // Drop kept buffers of other sizes before waiting for returns
+            if (dropOne()) continue;
+            returned.wait(lock);
+        }
+        allocated += size;
+        if (allocated > peakBytes) peakBytes = allocated;
+        lock.unlock();
+
+        uint8_t* bytes = static_cast<uint8_t*>(::operator new(size, std::align_val_t(POOL_ALIGNMENT), std::nothrow));
+        if (!bytes) {
+            lock.lock();
+            allocated -= size;
+            returned.notify_all();
+            throw std::bad_alloc();
+        }
+        return PooledBuffer(this, bytes, size);
+    }
+
+    // Free the buffers kept for reuse
+    void trim() {
+        std::lock_guard<std::mutex> guard(mutex);
+        while (dropOne()) {}
+        returned.notify_all();
+    }
+
+private:
+    friend class PooledBuffer;
+
+    void give(uint8_t* bytes, size_t size) {
+        std::lock_guard<std::mutex> guard(mutex);
+        kept.emplace_back(bytes, size);
+        returned.notify_all();
+    }
+
+    bool dropOne() {
+        if (kept.empty()) return false;
+        ::operator delete(kept.back().first, std::align_val_t(POOL_ALIGNMENT));
+        allocated -= kept.back().second;
+        kept.pop_back();
+        return true;
+    }
+
+    static size_t roundUp(size_t size) {
+        return (size + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT * POOL_ALIGNMENT;
+    }
+
+    const size_t ceiling;
+    size_t allocated = 0;   // In use plus kept for reuse
+    size_t peakBytes = 0;
+    std::vector<std::pair<uint8_t*, size_t>> kept;
+    std::mutex mutex;
+    std::condition_variable returned;
+};
+
+inline void PooledBuffer::reset() {
+    if (pool) pool->give(bytes, length);
+    pool = nullptr;
+    bytes = nullptr;
+    length = 0;
+}
+
+// "512M" -> 536870912; plain numbers are bytes. 0 if malformed.
+inline size_t parseMemorySize(const std::string& text) {
+    char* end = nullptr;
+    unsigned long long value = strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) return 0;
+    std::string suffix(end);
+    if (suffix == "K" || suffix == "k") return (size_t)value << 10;
+    if (suffix == "M" || suffix == "m") return (size_t)value << 20;
+    if (suffix == "G" || suffix == "g") return (size_t)value << 30;
+    return suffix.empty() ? (size_t)value : 0;
+}
+
+inline size_t configuredMemoryLimit() {
+    const char* text = getenv("HASH_MEMORY_LIMIT");
+    size_t limit = text ? parseMemorySize(text) : 0;
+    if (limit == 0) return DEFAULT_MEMORY_LIMIT;
+    return limit < MIN_MEMORY_LIMIT ? MIN_MEMORY_LIMIT : limit;
+}
+
+inline BufferPool& sharedBufferPool() {
+    static BufferPool pool(configuredMemoryLimit());
+    return pool;
+}
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef CANCEL_TOKEN_H
+#define CANCEL_TOKEN_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+    // Keep windows.h from defining min/max macros over std::min/std::max
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <csignal>
+#endif
+
+// Cooperative cancellation for the stdin hashers. SIGTERM and SIGINT (on
+// Windows Ctrl+C, Ctrl+Break and console close) only raise a flag; the read
+// loop checks it after every buffer, hashes what it already read and stops.
+// Cancelling therefore costs at most one buffer and keeps the partial state.
+// The handlers are installed without SA_RESTART, so a read blocked on an idle
+// pipe or ring doorbell returns at once (CancelSynchronousIo on Windows).
+//
+// On cancel the hasher prints "CANCELLED <bytes hashed>" on stdout and exits
+// with EXIT_CANCELLED. With --midstate it adds "MIDSTATE <algo> <hex>" per
+// algorithm (hasher_state.h); --resume FILE, given that output, carries on
+// from there when fed the input from offset <bytes hashed>.
+
+constexpr int EXIT_CANCELLED = 2;
+
+inline std::atomic<bool> cancelFlag{false};
+static_assert(std::atomic<bool>::is_always_lock_free, "the signal handler needs a lock-free flag");
+
+inline bool cancelRequested() {
+    return cancelFlag.load(std::memory_order_relaxed);
+}
+
+#ifdef _WIN32
+inline HANDLE cancelReaderThread = nullptr;   // Thread blocked in ReadFile on stdin
+
+inline BOOL WINAPI onCancelEvent(DWORD event) {
+    if (event != CTRL_C_EVENT && event != CTRL_BREAK_EVENT && event != CTRL_CLOSE_EVENT) return FALSE;
+    cancelFlag.store(true);
+    if (cancelReaderThread) CancelSynchronousIo(cancelReaderThread);
+    return TRUE;
+}
+#else
+inline void onCancelSignal(int) {
+    cancelFlag.store(true);
+}
+#endif
+
+// Call from the thread that reads the input
+inline void installCancelHandlers() {
+#ifdef _WIN32
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &cancelReaderThread, 0, FALSE,
+                    DUPLICATE_SAME_ACCESS);
+    SetConsoleCtrlHandler(onCancelEvent, TRUE);
+#else
+    struct sigaction action = {};
+    action.sa_handler = onCancelSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;   // No SA_RESTART: interrupt the blocked read
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+#endif
+}
+
+struct CancelOptions {
+    bool midstate = false;    // Print midstates when cancelled
+    std::string resumePath;   // Output of a cancelled run to resume from
+};
+
+inline CancelOptions parseCancelOptions(int argc, char* argv[], int first = 1) {
+    CancelOptions options;
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--midstate") options.midstate = true;
+        if (arg == "--resume" && i + 1 < argc) options.resumePath = argv[++i];
+    }
+    return options;
+}
+
+// A cancelled run's output: bytes hashed, then (algorithm, state) pairs. The
+// algorithm name is what keeps e.g. a SHA-256 state (same size and layout)
+// out of a SHA-224 hasher.
+struct ResumePoint {
+    uint64_t bytes = 0;
+    std::vector<std::pair<std::string, std::string>> states;
+
+    const std::string* state(const std::string& algorithm) const {
+        for (const auto& entry : states) {
+            if (entry.first == algorithm) return &entry.second;
+        }
+        return nullptr;
+    }
+};
+
+inline bool readResumePoint(const std::string& path, ResumePoint& point, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "Cannot open " + path;
+        return false;
+    }
+    bool cancelled = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string tag, first, second;
+        fields >> tag >> first >> second;
+        if (tag == "CANCELLED" && !first.empty()) {
+            point.bytes = std::strtoull(first.c_str(), nullptr, 10);
+            cancelled = true;
+        } else if (tag == "MIDSTATE" && !second.empty()) {
+            point.states.emplace_back(first, second);
+        }
+    }
+    if (!cancelled || point.states.empty()) {
+        error = path + " holds no midstate (cancel with --midstate to get one)";
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -3,7 +3,19 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <array>
+#include <string_view>
+#include <chrono>
+#include "cancel_token.h"
+#include "cpu_dispatch.h"
+#include "hasher_state.h"
+#include "shm_ring.h"
+#include "tuning.h"
 
 // Platform-specific includes for binary mode
 #ifdef _WIN32
@@ -23,18 +35,216 @@ inline std::string readStdinToString() {
     return std::string((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
 }
 
-// Report progress to stderr for GUI monitoring
-// Format: "PROGRESS:XX" where XX is percentage (0-100)
-inline void reportProgress(size_t bytesProcessed, size_t totalBytes) {
-    if (totalBytes == 0) return;
-    int percentage = static_cast<int>((bytesProcessed * 100) / totalBytes);
-    // Only report on 5% increments to avoid flooding
-    static int lastReported = -5;
-    if (percentage >= lastReported + 5 || percentage == 100) {
-        std::fprintf(stderr, "PROGRESS:%d\n", percentage);
+// Progress records on stderr for GUI monitoring, at most one per interval:
+//   "PROGRESS <bytes> <total> <bytes_per_s> <eta_s>"
+// total is 0 and eta_s is -1 when the input size is unknown. bytes_per_s is
+// smoothed over recent intervals. A record at 0 bytes and a final record at
+// the end of input are always written, so short inputs still report.
+// A resumed hash starts counting at startBytes, so the bytes hashed before
+// the cancel do not show up as throughput.
+constexpr double PROGRESS_INTERVAL_SECONDS = 0.2;
+
+class ProgressReporter {
+public:
+    ProgressReporter(bool enabled, uint64_t totalBytes, uint64_t startBytes = 0,
+                     double interval = PROGRESS_INTERVAL_SECONDS)
+        : enabled(enabled), totalBytes(totalBytes), interval(interval), lastBytes(startBytes) {
+        lastTime = std::chrono::steady_clock::now();
+        if (enabled) emit(startBytes, lastTime);
+    }
+
+    void update(uint64_t bytes) {
+        if (!enabled) return;
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - lastTime).count() >= interval) emit(bytes, now);
+    }
+
+    void finish(uint64_t bytes) {
+        if (enabled) emit(bytes, std::chrono::steady_clock::now());
+    }
+
+private:
+    void emit(uint64_t bytes, std::chrono::steady_clock::time_point now) {
+        double window = std::chrono::duration<double>(now - lastTime).count();
+        if (window > 0 && bytes > lastBytes) {
+            double windowRate = (bytes - lastBytes) / window;
+            rate = rate > 0 ? 0.7 * rate + 0.3 * windowRate : windowRate;
+        }
+        double eta = -1;
+        if (totalBytes > 0 && rate > 0) eta = bytes >= totalBytes ? 0 : (totalBytes - bytes) / rate;
+
+        std::fprintf(stderr, "PROGRESS %llu %llu %.0f %.1f\n", (unsigned long long)bytes,
+                     (unsigned long long)totalBytes, rate, eta);
         std::fflush(stderr);
-        lastReported = percentage;
+        lastTime = now;
+        lastBytes = bytes;
+    }
+
+    bool enabled;
+    uint64_t totalBytes;
+    double interval;
+    std::chrono::steady_clock::time_point lastTime;
+    uint64_t lastBytes;
+    double rate = 0;
+};
+
+// Convert a digest to a lowercase hexadecimal string
+inline std::string toHex(const uint8_t* data, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(length * 2, '0');
+    for (size_t i = 0; i < length; ++i) {
+        hex[i * 2] = digits[data[i] >> 4];
+        hex[i * 2 + 1] = digits[data[i] & 0x0F];
+    }
+    return hex;
+}
+
+// Compare a digest against a hex literal; usable in static_assert
+template <size_t N>
+constexpr bool digestMatches(const std::array<uint8_t, N>& digest, std::string_view hex) {
+    if (hex.size() != N * 2) return false;
+    for (size_t i = 0; i < hex.size(); ++i) {
+        char c = hex[i];
+        int nibble = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+        int expected = (i % 2 == 0) ? digest[i / 2] >> 4 : digest[i / 2] & 0x0F;
+        if (nibble != expected) return false;
+    }
+    return true;
+}
+
+struct ProgressOptions {
+    bool enabled = false;
+    bool sizeGiven = false;
+    uint64_t totalBytes = 0;
+};
+
+// One progress argument: the expected input size the GUI passes (enables
+// progress, at most once), or "--progress" for input of unknown size.
+// False if arg is neither.
+inline bool parseProgressArgument(const std::string& arg, ProgressOptions& options) {
+    if (arg == "--progress") {
+        options.enabled = true;
+        return true;
     }
+    if (options.sizeGiven || arg.empty() || arg.size() > 19 ||
+        arg.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    options.totalBytes = std::stoull(arg);
+    options.sizeGiven = true;
+    options.enabled = true;
+    return true;
+}
+
+// Progress arguments from argv[first..]; other arguments are skipped
+inline ProgressOptions parseProgressOptions(int argc, char* argv[], int first = 1) {
+    ProgressOptions options;
+    for (int i = first; i < argc; ++i) parseProgressArgument(argv[i], options);
+    return options;
+}
+
+// Stream stdin through an incremental hasher and print its hex digest.
+// Hasher provides update(const uint8_t*, size_t) and finalize(uint8_t*);
+// algorithm is its registry name, which tags midstates.
+// The kernel variant and buffer size come from the host's tuning profile.
+// "--cpu-features" prints the kernel variant the hasher dispatched to instead.
+// "--ring MEMFD:DATAFD:SPACEFD[:PID]" reads a shared-memory ring instead of stdin.
+// SIGTERM / SIGINT stop it within one buffer; "--midstate" and "--resume FILE"
+// make that resumable (see cancel_token.h).
+template <typename Hasher>
+int hashStdinMain(const char* algorithm, int argc, char* argv[]) {
+    applyTunedKernel(Hasher::dispatch());
+
+    if (argc > 1 && std::string(argv[1]) == "--cpu-features") {
+        std::cout << "cpu " << describeCpuFeatures() << '\n'
+                  << "backend " << Hasher::dispatch().backend() << std::endl;
+        return 0;
+    }
+
+    initBinaryMode();
+    installCancelHandlers();
+
+    ProgressOptions options = parseProgressOptions(argc, argv);
+    CancelOptions cancelOptions = parseCancelOptions(argc, argv);
+
+    ShmRingReader ring;
+    std::string ringSpec = ringOption(argc, argv);
+    std::string error;
+    if (!ringSpec.empty() && !ring.open(ringSpec, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    Hasher hasher;
+    uint64_t totalBytes = 0;
+    if (!cancelOptions.resumePath.empty()) {
+        ResumePoint point;
+        if (!readResumePoint(cancelOptions.resumePath, point, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        const std::string* state = point.state(algorithm);
+        if (!state || !loadHasherState(*state, hasher)) {
+            std::cerr << "No usable " << algorithm << " midstate in " << cancelOptions.resumePath << std::endl;
+            return 1;
+        }
+        totalBytes = point.bytes;
+    }
+    const size_t bufferSize = tunedBufferSize();
+    std::vector<uint8_t> buffer(ring.active() ? 0 : bufferSize);
+    ProgressReporter progress(options.enabled, options.totalBytes, totalBytes);
+
+    bool cancelled = false;
+    while (!cancelled) {
+        // Also before each read: a cancel that arrived while hashing would
+        // otherwise wait for more input first
+        if (cancelRequested()) {
+            cancelled = true;
+            break;
+        }
+        const uint8_t* data = buffer.data();
+        size_t bytesRead;
+        if (ring.active()) {
+            if (!ring.next(bufferSize, data, bytesRead, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        } else {
+            std::cin.read((char*)buffer.data(), bufferSize);
+            bytesRead = std::cin.gcount();
+            // As in HashEngine: stdio read errors only show in ferror, and a
+            // read interrupted by a cancel is not an error
+            if ((std::cin.bad() || ferror(stdin)) && !cancelRequested()) {
+                std::cerr << "Error reading standard input: " << strerror(errno) << std::endl;
+                return 1;
+            }
+        }
+        // What was read before a cancel is still hashed, so the midstate covers it
+        cancelled = cancelRequested();
+        if (bytesRead == 0) break;
+
+        hasher.update(data, bytesRead);
+        ring.release();
+        totalBytes += bytesRead;
+        progress.update(totalBytes);
+    }
+    progress.finish(totalBytes);
+
+    if (cancelled) {
+        std::cout << "CANCELLED " << totalBytes << '\n';
+        if (cancelOptions.midstate) std::cout << "MIDSTATE " << algorithm << ' ' << saveHasherState(hasher) << '\n';
+        std::cout.flush();
+        return EXIT_CANCELLED;
+    }
+
+    uint8_t digest[Hasher::DIGEST_SIZE];
+    hasher.finalize(digest);
+
+    std::cout << toHex(digest, Hasher::DIGEST_SIZE);
+    std::cout.flush();
+    std::cout << std::endl;
+
+    return 0;
 }
 
 #endif
@@ -0,0 +1,134 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Runtime CPU-feature dispatch.
+// Binaries are built for the baseline ISA; every kernel variant is compiled
+// in with a target attribute and the best one the CPU supports is picked on
+// first use. HASH_BACKEND=<name> forces a variant (if the CPU supports it),
+// e.g. HASH_BACKEND=scalar to rule out a SIMD kernel.
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define HASH_X86 1
+    #include <cpuid.h>
+    #include <immintrin.h>
+    #define HASH_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+struct CpuFeatures {
+    bool sse41 = false;
+    bool avx2 = false;     // With BMI2, which the AVX2 variants also use
+    bool avx512 = false;   // AVX-512 F + VL
+    bool shaNi = false;
+    bool pclmul = false;
+};
+
+inline CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+#if HASH_X86
+    // __builtin_cpu_supports also checks that the OS saves the wide registers
+    __builtin_cpu_init();
+    features.sse41 = __builtin_cpu_supports("sse4.1");
+    features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+    features.avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl");
+    features.pclmul = features.sse41 && __builtin_cpu_supports("pclmul");
+
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        features.shaNi = features.sse41 && (ebx & (1u << 29));
+    }
+#endif
+    return features;
+}
+
+inline const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+// Space-separated list of the features the kernels care about
+inline std::string describeCpuFeatures() {
+    const CpuFeatures& f = cpuFeatures();
+    std::string text;
+    if (f.sse41) text += " sse4.1";
+    if (f.avx2) text += " avx2";
+    if (f.avx512) text += " avx512";
+    if (f.shaNi) text += " sha-ni";
+    if (f.pclmul) text += " pclmul";
+    return text.empty() ? "none" : text.substr(1);
+}
+
+template <typename Function>
+struct KernelVariant {
+    const char* name;
+    bool supported;
+    Function function;
+};
+
+// Type-erased view of a dispatch table, for tools that tune or report on
+// every algorithm without knowing its kernel signature
+class KernelSelector {
+public:
+    explicit KernelSelector(const char* tableName) : tableName(tableName) {}
+    virtual ~KernelSelector() {}
+
+    // Kernel family name; shared by algorithms with one kernel (SHA-224/256)
+    const char* name() const { return tableName; }
+    virtual const char* backend() const = 0;
+    virtual bool select(const char* variant) = 0;
+    virtual std::vector<const char*> supportedVariants() const = 0;
+
+private:
+    const char* tableName;
+};
+
+// Variant table for one kernel family; variants are listed slowest first
+template <typename Function>
+class KernelDispatch : public KernelSelector {
+public:
+    KernelDispatch(const char* tableName, std::vector<KernelVariant<Function>> variantList)
+        : KernelSelector(tableName), variantList(variantList) {
+        const char* forced = getenv("HASH_BACKEND");
+        if (!forced || !select(forced)) select(nullptr);
+    }
+
+    KernelDispatch(const KernelDispatch&) = delete;
+    KernelDispatch& operator=(const KernelDispatch&) = delete;
+
+    Function function() const { return active->function; }
+    const char* backend() const override { return active->name; }
+    const std::vector<KernelVariant<Function>>& variants() const { return variantList; }
+
+    std::vector<const char*> supportedVariants() const override {
+        std::vector<const char*> names;
+        for (const KernelVariant<Function>& variant : variantList) {
+            if (variant.supported) names.push_back(variant.name);
+        }
+        return names;
+    }
+
+    // Switch to a named variant, or the best supported one for nullptr.
+    // Not synchronised: call before hashing starts.
+    bool select(const char* name) override {
+        const KernelVariant<Function>* chosen = nullptr;
+        for (const KernelVariant<Function>& variant : variantList) {
+            if (!variant.supported) continue;
+            if (!name || strcmp(name, variant.name) == 0) chosen = &variant;
+        }
+        if (!chosen) return false;
+        active = chosen;
+        return true;
+    }
+
+private:
+    std::vector<KernelVariant<Function>> variantList;
+    const KernelVariant<Function>* active = nullptr;
+};
+
+#endif
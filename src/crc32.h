@@ -0,0 +1,253 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string_view>
+#include "cpu_dispatch.h"
+
+// CRC-32 polynomial (IEEE 802.3)
+constexpr uint32_t CRC32_POLYNOMIAL = 0xEDB88320;
+
+// Generate CRC-32 lookup table
+constexpr std::array<uint32_t, 256> generateCRC32Table()
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (uint32_t j = 0; j < 8; j++) {
+            if (crc & 1) {
+                crc = (crc >> 1) ^ CRC32_POLYNOMIAL;
+            } else {
+                crc >>= 1;
+            }
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+// Built at compile time, so no table setup on startup
+constexpr std::array<uint32_t, 256> CRC32_TABLE = generateCRC32Table();
+
+// Byte-at-a-time table update of the raw (un-inverted) CRC register
+constexpr uint32_t crc32UpdateTable(uint32_t crc, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t index = (crc ^ data[i]) & 0xFF;
+        crc = (crc >> 8) ^ CRC32_TABLE[index];
+    }
+    return crc;
+}
+
+typedef uint32_t (*Crc32UpdateFunction)(uint32_t, const uint8_t*, size_t);
+
+#if HASH_X86
+// Carry-less multiply folding (Intel, "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ"): four 128-bit lanes folded 64 bytes at a
+// time, reduced to one lane, then Barrett-reduced to 32 bits. Constants are
+// the bit-reflected x^k mod P values for the IEEE polynomial.
+HASH_TARGET("pclmul,sse4.1")
+inline __m128i crc32Fold128(__m128i x, __m128i next, __m128i constants) {
+    __m128i low = _mm_clmulepi64_si128(x, constants, 0x00);
+    __m128i high = _mm_clmulepi64_si128(x, constants, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, low), next);
+}
+
+HASH_TARGET("pclmul,sse4.1")
+inline uint32_t crc32UpdatePclmul(uint32_t crc, const uint8_t* data, size_t length) {
+    if (length < 64) return crc32UpdateTable(crc, data, length);
+
+    const __m128i K1K2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i K3K4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i K5 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i POLY = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i LOW32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_loadu_si128((const __m128i*)(data + 0x00));
+    __m128i x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+    __m128i x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+    __m128i x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    data += 64;
+    length -= 64;
+
+    // Fold 512 bits at a time
+    while (length >= 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, K1K2, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, K1K2, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, K1K2, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, K1K2, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, K1K2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, K1K2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, K1K2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, K1K2, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(data + 0x30)));
+        data += 64;
+        length -= 64;
+    }
+
+    // Fold the four lanes into one, then any remaining 16-byte blocks
+    x1 = crc32Fold128(x1, x2, K3K4);
+    x1 = crc32Fold128(x1, x3, K3K4);
+    x1 = crc32Fold128(x1, x4, K3K4);
+    while (length >= 16) {
+        x1 = crc32Fold128(x1, _mm_loadu_si128((const __m128i*)data), K3K4);
+        data += 16;
+        length -= 16;
+    }
+
+    // 128 -> 64 bits
+    x2 = _mm_clmulepi64_si128(x1, K3K4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, LOW32);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, K5, 0x00), x2);
+
+    // Barrett reduction to 32 bits
+    x2 = _mm_and_si128(x1, LOW32);
+    x2 = _mm_clmulepi64_si128(x2, POLY, 0x10);
+    x2 = _mm_and_si128(x2, LOW32);
+    x2 = _mm_clmulepi64_si128(x2, POLY, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    crc = (uint32_t)_mm_extract_epi32(x1, 1);
+
+    return crc32UpdateTable(crc, data, length);
+}
+#endif
+
+inline KernelDispatch<Crc32UpdateFunction>& crc32Dispatch() {
+    static KernelDispatch<Crc32UpdateFunction> dispatch("CRC-32", {
+        {"scalar", true, crc32UpdateTable},
+#if HASH_X86
+        {"pclmul", cpuFeatures().pclmul, crc32UpdatePclmul},
+#endif
+    });
+    return dispatch;
+}
+
+// Incremental CRC-32, same interface as the block hashers
+class Crc32 {
+public:
+    static constexpr size_t DIGEST_SIZE = 4;
+    typedef std::array<uint8_t, DIGEST_SIZE> Digest;
+
+    constexpr Crc32() {}
+
+    constexpr void reset() {
+        crc = 0xFFFFFFFF;
+    }
+
+    constexpr void update(const uint8_t* data, size_t length) {
+        if (__builtin_is_constant_evaluated()) {
+            crc = crc32UpdateTable(crc, data, length);
+            return;
+        }
+        crc = crc32Dispatch().function()(crc, data, length);
+    }
+
+    constexpr void update(const char* data, size_t length) {
+        if (!__builtin_is_constant_evaluated()) {
+            update(reinterpret_cast<const uint8_t*>(data), length);
+            return;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            uint8_t index = (crc ^ static_cast<uint8_t>(data[i])) & 0xFF;
+            crc = (crc >> 8) ^ CRC32_TABLE[index];
+        }
+    }
+
+    constexpr void update(std::string_view text) {
+        update(text.data(), text.size());
+    }
+
+    // Final XOR applied; does not modify the running state
+    constexpr uint32_t value() const {
+        return crc ^ 0xFFFFFFFF;
+    }
+
+    // Digest bytes are the CRC value in big endian, matching its hex form
+    constexpr void finalize(uint8_t* out) const {
+        uint32_t result = value();
+        for (int i = 0; i < 4; ++i) {
+            out[i] = (result >> ((3 - i) * 8)) & 0xFF;
+        }
+    }
+
+    constexpr Digest digest() const {
+        Digest out{};
+        finalize(out.data());
+        return out;
+    }
+
+    static constexpr uint32_t hash(std::string_view text) {
+        Crc32 crc32;
+        crc32.update(text);
+        return crc32.value();
+    }
+
+    static KernelDispatch<Crc32UpdateFunction>& dispatch() {
+        return crc32Dispatch();
+    }
+
+    // Every register value is reachable
+    constexpr bool validState() const {
+        return true;
+    }
+
+private:
+    uint32_t crc = 0xFFFFFFFF;
+};
+
+// GF(2) matrix helpers for crc32Combine (zlib's method)
+constexpr uint32_t gf2MatrixTimes(const uint32_t* matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    for (int i = 0; vector; vector >>= 1, ++i) {
+        if (vector & 1) sum ^= matrix[i];
+    }
+    return sum;
+}
+
+constexpr void gf2MatrixSquare(uint32_t* square, const uint32_t* matrix) {
+    for (int n = 0; n < 32; ++n) {
+        square[n] = gf2MatrixTimes(matrix, matrix[n]);
+    }
+}
+
+// CRC of A followed by B, given crc(A), crc(B) and B's length.
+// Lets independently computed segments of a file be joined in order.
+constexpr uint32_t crc32Combine(uint32_t crcA, uint32_t crcB, uint64_t lengthB) {
+    if (lengthB == 0) return crcA;
+
+    uint32_t even[32] = {};
+    uint32_t odd[32] = {};
+
+    // Operator for one zero bit
+    odd[0] = CRC32_POLYNOMIAL;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; ++n) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    gf2MatrixSquare(even, odd);   // Two zero bits
+    gf2MatrixSquare(odd, even);   // Four zero bits
+
+    // Apply lengthB zero bytes to crcA
+    do {
+        gf2MatrixSquare(even, odd);
+        if (lengthB & 1) crcA = gf2MatrixTimes(even, crcA);
+        lengthB >>= 1;
+        if (lengthB == 0) break;
+
+        gf2MatrixSquare(odd, even);
+        if (lengthB & 1) crcA = gf2MatrixTimes(odd, crcA);
+        lengthB >>= 1;
+    } while (lengthB != 0);
+
+    return crcA ^ crcB;
+}
+
+#endif
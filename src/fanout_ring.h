@@ -0,0 +1,130 @@
+#ifndef FANOUT_RING_H
+#define FANOUT_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "buffer_pool.h"
+#include "cpu_dispatch.h"
+
+// Single-producer / multi-consumer ring for the fan-out engine: one reader
+// fills buffers, every consumer (one thread per algorithm) sees every buffer
+// in order. Slots are reference counted; the last consumer to release a slot
+// hands it back to the producer. The hand-off itself is lock-free (one
+// release store to publish, one fetch_sub per consumer); a side that finds
+// nothing to do spins briefly, then sleeps on a condition variable that is
+// only touched when someone is actually asleep.
+//
+// A slow algorithm holds slots for longer, so the ring has a few slots and
+// the fast algorithms run ahead until the slowest one is SLOTS buffers behind.
+// The slots are slices of one block from sharedBufferPool(); slotSize() may
+// be below the requested size when the pool's ceiling is smaller.
+
+class FanoutRing {
+public:
+    FanoutRing(size_t slotCount, size_t slotSize, size_t consumerCount)
+        : block(sharedBufferPool().acquire(slotCount * slotSize)), slots(slotCount), consumers(consumerCount),
+          positions(consumerCount) {
+        bytesPerSlot = std::min(slotSize, block.size() / slotCount);
+        for (size_t i = 0; i < slotCount; ++i) slots[i].buffer = block.data() + i * bytesPerSlot;
+    }
+
+    FanoutRing(const FanoutRing&) = delete;
+    FanoutRing& operator=(const FanoutRing&) = delete;
+
+    size_t slotSize() const { return bytesPerSlot; }
+
+    // Producer: buffer for the next publish(), once every consumer is done
+    // with its previous contents. Calling it again before publish() returns
+    // the same buffer.
+    uint8_t* acquire() {
+        Slot& slot = slots[producerPosition % slots.size()];
+        waitUntil([&]() { return slot.references.load() == 0; });
+        return slot.buffer;
+    }
+
+    // Producer: hand the acquired buffer to every consumer
+    void publish(size_t length) {
+        Slot& slot = slots[producerPosition % slots.size()];
+        slot.length = length;
+        slot.references.store(consumers, std::memory_order_relaxed);
+        published.store(++producerPosition);   // seq_cst, pairs with the consumers' load in waitUntil
+        wake();
+    }
+
+    // Producer: end of input
+    void finish() {
+        acquire();
+        publish(0);
+    }
+
+    // Consumer: the next buffer; false at end of input
+    bool next(size_t consumer, const uint8_t*& data, size_t& length) {
+        uint64_t position = positions[consumer].value;
+        waitUntil([&]() { return published.load() > position; });
+        const Slot& slot = slots[position % slots.size()];
+        data = slot.buffer;
+        length = slot.length;
+        return length != 0;
+    }
+
+    // Consumer: done with the buffer from next()
+    void release(size_t consumer) {
+        Slot& slot = slots[positions[consumer].value++ % slots.size()];
+        if (slot.references.fetch_sub(1) == 1) wake();
+    }
+
+private:
+    struct Slot {
+        uint8_t* buffer = nullptr;   // Slice of block
+        size_t length = 0;
+        std::atomic<size_t> references{0};   // Consumers yet to release it
+    };
+
+    // Per-consumer read position, on its own cache line
+    struct alignas(64) Position {
+        uint64_t value = 0;
+    };
+
+    template <typename Ready>
+    void waitUntil(Ready ready) {
+        for (int spin = 0; spin < 2048; ++spin) {
+            if (ready()) return;
+#if HASH_X86
+            _mm_pause();
+#endif
+            if (spin % 256 == 255) std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        while (!ready()) wakeup.wait(lock);
+        sleepers.fetch_sub(1);
+    }
+
+    // After a seq_cst store: either a sleeper sees the new state before it
+    // sleeps, or this sees the sleeper and notifies it under the mutex
+    void wake() {
+        if (sleepers.load() == 0) return;
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeup.notify_all();
+    }
+
+    PooledBuffer block;
+    size_t bytesPerSlot = 0;
+    std::vector<Slot> slots;
+    size_t consumers;
+    std::vector<Position> positions;
+    uint64_t producerPosition = 0;   // Producer-only
+    alignas(64) std::atomic<uint64_t> published{0};
+    alignas(64) std::atomic<int> sleepers{0};
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+};
+
+#endif
@@ -0,0 +1,533 @@
+#ifndef FILE_READER_H
+#define FILE_READER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <fcntl.h>
+#include "buffer_pool.h"
+#include "trace.h"
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+    #include <pthread.h>
+    #include <csignal>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+    #include <linux/io_uring.h>
+    // <linux/fs.h> (pulled in by io_uring.h) defines BLOCK_SIZE, which clashes with the hashers
+    #undef BLOCK_SIZE
+#endif
+
+#ifndef O_BINARY
+    #define O_BINARY 0
+#endif
+
+// Input backends for hashing whole files.
+// Every backend hands the file to a consumer in order, one chunk at a time.
+// Read buffers come from sharedBufferPool(), so concurrent readers share one
+// memory ceiling (see buffer_pool.h):
+//   "read"     plain read() into a reusable buffer
+//   "pipe"     file copied through a pipe by a writer thread (the GUI's stdin path)
+//   "mmap"     zero-copy view of a private mapping (POSIX)
+//   "io_uring" queued asynchronous reads, several buffers in flight (Linux)
+//   "direct"   read() with O_DIRECT into aligned buffers, bypassing the page cache (Linux)
+
+typedef std::function<void(const uint8_t*, size_t)> ChunkConsumer;
+
+inline std::string systemError(const std::string& what) {
+    return what + ": " + strerror(errno);
+}
+
+// read() loop into a buffer the caller owns; ends early once *stop is set
+inline bool readIntoBuffer(const std::string& path, uint8_t* buffer, size_t bufferSize, const ChunkConsumer& consume,
+                           std::string& error, const bool* stop = nullptr) {
+    int fd = open(path.c_str(), O_RDONLY | O_BINARY);
+    if (fd < 0) {
+        error = systemError("open " + path);
+        return false;
+    }
+
+    bool ok = true;
+    while (!(stop && *stop)) {
+        long bytesRead;
+        {
+            TraceSpan span("read_wait");
+            bytesRead = read(fd, buffer, bufferSize);
+            span.setBytes(bytesRead > 0 ? bytesRead : 0);
+        }
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            error = systemError("read");
+            ok = false;
+            break;
+        }
+        if (bytesRead == 0) break;
+        consume(buffer, bytesRead);
+    }
+    close(fd);
+    return ok;
+}
+
+inline bool readWithRead(const std::string& path, size_t bufferSize, const ChunkConsumer& consume, std::string& error) {
+    PooledBuffer buffer = sharedBufferPool().acquire(bufferSize);
+    return readIntoBuffer(path, buffer.data(), std::min(bufferSize, buffer.size()), consume, error);
+}
+
+#ifndef _WIN32
+
+// Write all bytes, retrying partial writes
+inline bool writeAll(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+inline bool readWithPipe(const std::string& path, size_t bufferSize, const ChunkConsumer& consume, std::string& error) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        error = systemError("pipe");
+        return false;
+    }
+
+    // Both halves in one acquire, so the writer never waits on the pool while
+    // this side holds its buffer
+    PooledBuffer buffers = sharedBufferPool().acquire(2 * bufferSize);
+    bufferSize = std::min(bufferSize, buffers.size() / 2);
+    uint8_t* buffer = buffers.data();
+
+    // Producer side, like the GUI streaming the file into the executable's
+    // stdin. SIGPIPE is blocked on this thread, so when the reading side stops
+    // early and closes its end, write() fails with EPIPE and the writer stops
+    // instead of the signal killing the process.
+    std::string writerError;
+    std::thread writer([&]() {
+        traceThreadName("pipe-writer");
+        sigset_t pipeSignal;
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+
+        bool stopped = false;
+        readIntoBuffer(path, buffer + bufferSize, bufferSize, [&](const uint8_t* data, size_t length) {
+            // Time blocked on a full pipe, i.e. the consumer falling behind
+            TraceSpan stall("queue_stall", nullptr, length);
+            if (!writeAll(fds[1], data, length)) {
+                writerError = systemError("write");
+                stopped = true;
+            }
+        }, writerError, &stopped);
+        close(fds[1]);
+    });
+
+    bool ok = true;
+    while (true) {
+        ssize_t bytesRead;
+        {
+            TraceSpan span("read_wait");
+            bytesRead = read(fds[0], buffer, bufferSize);
+            span.setBytes(bytesRead > 0 ? bytesRead : 0);
+        }
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            error = systemError("read");
+            ok = false;
+            break;
+        }
+        if (bytesRead == 0) break;
+        try {
+            consume(buffer, bytesRead);
+        } catch (...) {
+            close(fds[0]);
+            writer.join();
+            throw;
+        }
+    }
+    close(fds[0]);
+    writer.join();
+
+    if (ok && !writerError.empty()) {
+        error = writerError;
+        ok = false;
+    }
+    return ok;
+}
+
+inline bool readWithMmap(const std::string& path, size_t bufferSize, const ChunkConsumer& consume, std::string& error) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = systemError("open " + path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        error = systemError("fstat");
+        close(fd);
+        return false;
+    }
+    size_t fileSize = st.st_size;
+    if (fileSize == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        error = systemError("mmap");
+        return false;
+    }
+    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+    // Chunked so consumers see the same granularity as the copying backends
+    const uint8_t* data = static_cast<const uint8_t*>(mapping);
+    for (size_t offset = 0; offset < fileSize; offset += bufferSize) {
+        size_t length = fileSize - offset < bufferSize ? fileSize - offset : bufferSize;
+        consume(data + offset, length);
+    }
+
+    munmap(mapping, fileSize);
+    return true;
+}
+
+#endif
+
+#ifdef __linux__
+
+// Minimal io_uring ring over the raw syscalls (no liburing dependency)
+class IoUring {
+public:
+    IoUring() {}
+
+    ~IoUring() {
+        if (sqes) munmap(sqes, sqesSize);
+        if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing) munmap(sqRing, sqRingSize);
+        if (ringFd >= 0) close(ringFd);
+    }
+
+    bool init(unsigned entries, std::string& error) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ringFd = syscall(__NR_io_uring_setup, entries, &params);
+        if (ringFd < 0) {
+            error = systemError("io_uring_setup");
+            return false;
+        }
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) {
+            sqRingSize = cqRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+        }
+
+        sqRing = mapRing(sqRingSize, IORING_OFF_SQ_RING);
+        if (!sqRing) {
+            error = systemError("mmap sq ring");
+            return false;
+        }
+        cqRing = singleMmap ? sqRing : mapRing(cqRingSize, IORING_OFF_CQ_RING);
+        if (!cqRing) {
+            error = systemError("mmap cq ring");
+            return false;
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mapRing(sqesSize, IORING_OFF_SQES));
+        if (!sqes) {
+            error = systemError("mmap sqes");
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sqRing);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        char* cq = static_cast<char*>(cqRing);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // Queue one readv; submitted on the next wait()
+    void queueRead(int fd, const iovec* iov, uint64_t offset, uint64_t userData) {
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(iov);
+        sqe->len = 1;
+        sqe->off = offset;
+        sqe->user_data = userData;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++pending;
+    }
+
+    // Submit queued reads and block for at least one completion
+    bool wait(std::string& error) {
+        while (true) {
+            long rc = syscall(__NR_io_uring_enter, ringFd, pending, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (rc >= 0) {
+                pending -= rc < (long)pending ? rc : pending;
+                return true;
+            }
+            if (errno != EINTR) {
+                error = systemError("io_uring_enter");
+                return false;
+            }
+        }
+    }
+
+    // Pop one completion if available
+    bool popCompletion(uint64_t& userData, int& result) {
+        unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) return false;
+        io_uring_cqe* cqe = &cqes[head & *cqMask];
+        userData = cqe->user_data;
+        result = cqe->res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void* mapRing(size_t size, off_t offset) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, offset);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    int ringFd = -1;
+    unsigned pending = 0;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    size_t sqesSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+};
+
+// Keeps queueDepth reads in flight and consumes completed chunks in file order
+inline bool readWithIoUring(const std::string& path, size_t bufferSize, const ChunkConsumer& consume, std::string& error,
+                            unsigned queueDepth = 4) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = systemError("open " + path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        error = systemError("fstat");
+        close(fd);
+        return false;
+    }
+    // Every slot is a slice of one pooled block
+    PooledBuffer block = sharedBufferPool().acquire(queueDepth * bufferSize);
+    bufferSize = std::min<size_t>(bufferSize, block.size() / queueDepth);
+    uint64_t fileSize = st.st_size;
+    uint64_t chunkCount = (fileSize + bufferSize - 1) / bufferSize;
+
+    IoUring ring;
+    if (!ring.init(queueDepth, error)) {
+        close(fd);
+        return false;
+    }
+
+    auto slotBuffer = [&](unsigned slot) { return block.data() + (size_t)slot * bufferSize; };
+    std::vector<iovec> iovs(queueDepth);
+    std::vector<int> results(queueDepth, 0);
+    std::vector<bool> done(queueDepth, false);
+
+    auto chunkLength = [&](uint64_t chunk) {
+        uint64_t remaining = fileSize - chunk * bufferSize;
+        return remaining < bufferSize ? (size_t)remaining : bufferSize;
+    };
+    auto submit = [&](uint64_t chunk) {
+        unsigned slot = chunk % queueDepth;
+        iovs[slot].iov_base = slotBuffer(slot);
+        iovs[slot].iov_len = chunkLength(chunk);
+        done[slot] = false;
+        ring.queueRead(fd, &iovs[slot], chunk * bufferSize, slot);
+    };
+
+    uint64_t nextToSubmit = 0;
+    for (; nextToSubmit < chunkCount && nextToSubmit < queueDepth; ++nextToSubmit) {
+        submit(nextToSubmit);
+    }
+
+    bool ok = true;
+    for (uint64_t chunk = 0; chunk < chunkCount && ok; ++chunk) {
+        unsigned slot = chunk % queueDepth;
+        {
+            TraceSpan wait("read_wait", nullptr, chunkLength(chunk));
+            while (!done[slot]) {
+                if (!ring.wait(error)) {
+                    ok = false;
+                    break;
+                }
+                uint64_t userData;
+                int result;
+                while (ring.popCompletion(userData, result)) {
+                    done[userData] = true;
+                    results[userData] = result;
+                }
+            }
+        }
+        if (!ok) break;
+
+        size_t expected = chunkLength(chunk);
+        size_t got = results[slot] < 0 ? 0 : results[slot];
+        if (results[slot] < 0) {
+            errno = -results[slot];
+            error = systemError("io_uring read");
+            ok = false;
+            break;
+        }
+        // Finish a short read synchronously
+        while (got < expected) {
+            ssize_t n = pread(fd, slotBuffer(slot) + got, expected - got, chunk * bufferSize + got);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                // errno is stale when pread hits the end of a file that shrank
+                error = n == 0 ? "pread: unexpected end of file " + path : systemError("pread");
+                ok = false;
+                break;
+            }
+            got += n;
+        }
+        if (!ok) break;
+
+        consume(slotBuffer(slot), expected);
+        if (nextToSubmit < chunkCount) submit(nextToSubmit++);
+    }
+
+    // Drain outstanding reads before the buffers go away
+    if (!ok) {
+        std::string ignored;
+        for (uint64_t c = 0; c < nextToSubmit; ++c) {
+            unsigned slot = c % queueDepth;
+            while (!done[slot] && ring.wait(ignored)) {
+                uint64_t userData;
+                int result;
+                while (ring.popCompletion(userData, result)) done[userData] = true;
+            }
+        }
+    }
+
+    close(fd);
+    return ok;
+}
+
+inline bool readWithDirect(const std::string& path, size_t bufferSize, const ChunkConsumer& consume, std::string& error) {
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECT);
+    if (fd < 0) {
+        error = systemError("open O_DIRECT " + path);
+        return false;
+    }
+
+    // Pool buffers are page aligned and a whole number of pages
+    PooledBuffer pooled = sharedBufferPool().acquire(bufferSize);
+    uint8_t* buffer = pooled.data();
+    bufferSize = pooled.size();
+
+    bool ok = true;
+    while (true) {
+        ssize_t bytesRead;
+        {
+            TraceSpan span("read_wait");
+            bytesRead = read(fd, buffer, bufferSize);
+            span.setBytes(bytesRead > 0 ? bytesRead : 0);
+        }
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            error = systemError("read O_DIRECT");
+            ok = false;
+            break;
+        }
+        if (bytesRead == 0) break;
+        consume(buffer, bytesRead);
+    }
+
+    close(fd);
+    return ok;
+}
+
+#endif
+
+// Backends compiled into this build
+inline std::vector<std::string> availableReadBackends() {
+    std::vector<std::string> backends = {"read"};
+#ifndef _WIN32
+    backends.push_back("pipe");
+    backends.push_back("mmap");
+#endif
+#ifdef __linux__
+    backends.push_back("io_uring");
+    backends.push_back("direct");
+#endif
+    return backends;
+}
+
+// Read path with the named backend; false with error set on failure
+inline bool readFile(const std::string& backend, const std::string& path, size_t bufferSize,
+                     const ChunkConsumer& consume, std::string& error) {
+    if (backend == "read") return readWithRead(path, bufferSize, consume, error);
+#ifndef _WIN32
+    if (backend == "pipe") return readWithPipe(path, bufferSize, consume, error);
+    if (backend == "mmap") return readWithMmap(path, bufferSize, consume, error);
+#endif
+#ifdef __linux__
+    if (backend == "io_uring") return readWithIoUring(path, bufferSize, consume, error);
+    if (backend == "direct") return readWithDirect(path, bufferSize, consume, error);
+#endif
+    error = "Backend not available: " + backend;
+    return false;
+}
+
+// Best-effort eviction of a file's clean pages, for cold-cache measurements
+inline void evictFromPageCache(const std::string& path) {
+#ifdef __linux__
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+#else
+    (void)path;
+#endif
+}
+
+#endif
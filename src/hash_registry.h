@@ -0,0 +1,139 @@
+#ifndef HASH_REGISTRY_H
+#define HASH_REGISTRY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include "md5.h"
+#include "sha1.h"
+#include "sha2.h"
+#include "crc32.h"
+#include "hasher_state.h"
+#include "tuning.h"
+
+// Runtime-selectable hasher, for tools that pick algorithms by name.
+// Names match the GUI's algorithms.json entries.
+class DynamicHasher {
+public:
+    virtual ~DynamicHasher() {}
+    virtual const char* name() const = 0;
+    virtual size_t digestSize() const = 0;
+    virtual const char* backend() const = 0;   // Kernel variant in use
+    virtual void update(const uint8_t* data, size_t length) = 0;
+    virtual void finalize(uint8_t* out) = 0;
+    virtual void reset() = 0;
+    virtual std::unique_ptr<DynamicHasher> clone() const = 0;
+    // Midstate as hex (hasher_state.h); loadState is false if it does not fit
+    virtual std::string saveState() const = 0;
+    virtual bool loadState(const std::string& state) = 0;
+
+    std::string hexdigest() {
+        std::vector<uint8_t> digest(digestSize());
+        finalize(digest.data());
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        for (uint8_t byte : digest) {
+            hex += digits[byte >> 4];
+            hex += digits[byte & 0x0F];
+        }
+        return hex;
+    }
+};
+
+template <typename Hasher>
+class DynamicHasherImpl : public DynamicHasher {
+public:
+    explicit DynamicHasherImpl(const char* algorithmName) : algorithmName(algorithmName) {}
+
+    const char* name() const override { return algorithmName; }
+    size_t digestSize() const override { return Hasher::DIGEST_SIZE; }
+    const char* backend() const override { return Hasher::dispatch().backend(); }
+    void update(const uint8_t* data, size_t length) override { hasher.update(data, length); }
+    void finalize(uint8_t* out) override { hasher.finalize(out); }
+    void reset() override { hasher = Hasher(); }
+    std::unique_ptr<DynamicHasher> clone() const override {
+        return std::unique_ptr<DynamicHasher>(new DynamicHasherImpl(*this));
+    }
+    std::string saveState() const override { return saveHasherState(hasher); }
+    bool loadState(const std::string& state) override { return loadHasherState(state, hasher); }
+
+private:
+    const char* algorithmName;
+    Hasher hasher;
+};
+
+struct AlgorithmInfo {
+    const char* name;
+    size_t blockSize;   // Granularity of the underlying kernel
+    size_t digestSize;
+    std::unique_ptr<DynamicHasher> (*create)();
+    KernelSelector& (*kernels)();   // Dispatch table, shared within a family
+};
+
+template <typename Hasher>
+struct AlgorithmEntry {
+    static std::unique_ptr<DynamicHasher> create(const char* name) {
+        return std::unique_ptr<DynamicHasher>(new DynamicHasherImpl<Hasher>(name));
+    }
+};
+
+#define HASH_ALGORITHM(label, type, blockSize) \
+    {label, blockSize, type::DIGEST_SIZE, []() { return AlgorithmEntry<type>::create(label); }, \
+     []() -> KernelSelector& { return type::dispatch(); }}
+
+// Every algorithm the native engine provides
+inline constexpr AlgorithmInfo ALGORITHM_TABLE[] = {
+    HASH_ALGORITHM("MD5", Md5, 64),
+    HASH_ALGORITHM("SHA-1", Sha1, 64),
+    HASH_ALGORITHM("SHA-224", Sha224, 64),
+    HASH_ALGORITHM("SHA-256", Sha256, 64),
+    HASH_ALGORITHM("SHA-384", Sha384, 128),
+    HASH_ALGORITHM("SHA-512", Sha512, 128),
+    HASH_ALGORITHM("SHA-512/224", Sha512_224, 128),
+    HASH_ALGORITHM("SHA-512/256", Sha512_256, 128),
+    HASH_ALGORITHM("CRC-32", Crc32, 1),
+};
+
+constexpr size_t ALGORITHM_COUNT = sizeof(ALGORITHM_TABLE) / sizeof(ALGORITHM_TABLE[0]);
+
+inline const std::vector<AlgorithmInfo>& allAlgorithms() {
+    static const std::vector<AlgorithmInfo> algorithms(std::begin(ALGORITHM_TABLE), std::end(ALGORITHM_TABLE));
+    return algorithms;
+}
+
+#undef HASH_ALGORITHM
+
+// Feed one buffer to several hashers a tile at a time, so every algorithm
+// hashes a tile while it is still in L1 instead of each streaming the whole
+// buffer through L2 in turn. Tiles are a multiple of every block size, so
+// no hasher buffers a partial block between tiles.
+constexpr size_t FUSED_TILE_SIZE = 8 * 1024;
+
+inline void fusedUpdate(const std::vector<std::unique_ptr<DynamicHasher>>& hashers, const uint8_t* data,
+                        size_t length, size_t tileSize = FUSED_TILE_SIZE) {
+    for (size_t offset = 0; offset < length; offset += tileSize) {
+        size_t tile = std::min(tileSize, length - offset);
+        for (const auto& hasher : hashers) hasher->update(data + offset, tile);
+    }
+}
+
+// Apply the host tuning profile to every dispatch table
+inline void applyTunedKernels() {
+    for (const AlgorithmInfo& info : allAlgorithms()) {
+        applyTunedKernel(info.kernels());
+    }
+}
+
+// Look up an algorithm by name; nullptr if unknown
+inline std::unique_ptr<DynamicHasher> createHasher(const std::string& name) {
+    for (const AlgorithmInfo& info : allAlgorithms()) {
+        if (name == info.name) return info.create();
+    }
+    return nullptr;
+}
+
+#endif
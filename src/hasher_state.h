@@ -0,0 +1,53 @@
+#ifndef HASHER_STATE_H
+#define HASHER_STATE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Midstate of an incremental hasher as hex, for resuming an interrupted hash
+// (see cancel_token.h). Every hasher is a trivially copyable block of words,
+// so its bytes are the midstate. They are only meaningful to the same build;
+// validState() rejects a state that update() could not have produced.
+
+inline int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+template <typename Hasher>
+std::string saveHasherState(const Hasher& hasher) {
+    static_assert(std::is_trivially_copyable<Hasher>::value, "hasher state must be plain data");
+    static const char digits[] = "0123456789abcdef";
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&hasher);
+    std::string hex(sizeof(Hasher) * 2, '0');
+    for (size_t i = 0; i < sizeof(Hasher); ++i) {
+        hex[i * 2] = digits[bytes[i] >> 4];
+        hex[i * 2 + 1] = digits[bytes[i] & 0x0F];
+    }
+    return hex;
+}
+
+// False (hasher untouched) if hex is not a state of this hasher type
+template <typename Hasher>
+bool loadHasherState(const std::string& hex, Hasher& hasher) {
+    static_assert(std::is_trivially_copyable<Hasher>::value, "hasher state must be plain data");
+    if (hex.size() != sizeof(Hasher) * 2) return false;
+    uint8_t bytes[sizeof(Hasher)];
+    for (size_t i = 0; i < sizeof(Hasher); ++i) {
+        int high = hexNibble(hex[i * 2]);
+        int low = hexNibble(hex[i * 2 + 1]);
+        if (high < 0 || low < 0) return false;
+        bytes[i] = (uint8_t)(high << 4 | low);
+    }
+    Hasher restored;
+    memcpy(&restored, bytes, sizeof(Hasher));
+    if (!restored.validState()) return false;
+    hasher = restored;
+    return true;
+}
+
+#endif
@@ -0,0 +1,272 @@
+#ifndef LIVE_METRICS_H
+#define LIVE_METRICS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "hash_registry.h"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <process.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+#endif
+
+// Live metrics for long-running jobs, readable at any time by other processes
+// (see bench/watch_metrics.py). Hot paths only bump in-process atomics; a
+// publisher thread copies them into a fixed-layout snapshot every interval.
+//
+// POSIX: the snapshot lives in a shared mmap of the metrics file and is
+// guarded by a seqlock: `sequence` is odd while an update is in progress, so
+// a reader copies the block and retries if the sequence was odd or changed.
+// Windows: the whole file is rewritten and renamed into place, so a reader
+// always opens a complete snapshot.
+//
+// Layout (little-endian, 768 bytes):
+//   0   char[8]  magic "HASHMET2"
+//   8   u64      sequence
+//   16  u64      pid
+//   24  u64      start time, Unix ns
+//   32  u64      last update, Unix ns
+//   40  u64      files done
+//   48  u64      files queued (not started yet)
+//   56  u64      files active
+//   64  u64      queue depth (buffers waiting between pipeline stages)
+//   72  u64      errors
+//   80  u64      input bytes read
+//   88  f64      input bytes/s over the last interval (run average once finished)
+//   96  u32      algorithm count
+//   100 u32      finished (1 after the final update)
+//   104 char[24] input backend
+//   128 16 x { char[16] algorithm, char[16] kernel backend, u64 bytes hashed }
+
+// Every registry algorithm at once, with room for more
+constexpr size_t LIVE_METRICS_MAX_ALGORITHMS = 16;
+static_assert(ALGORITHM_COUNT <= LIVE_METRICS_MAX_ALGORITHMS, "live metrics must fit every algorithm");
+
+struct LiveMetricsAlgorithm {
+    char name[16];
+    char kernel[16];
+    uint64_t bytes;
+};
+
+struct LiveMetricsBlock {
+    char magic[8];
+    uint64_t sequence;
+    uint64_t pid;
+    uint64_t startNs;
+    uint64_t updateNs;
+    uint64_t filesDone;
+    uint64_t filesQueued;
+    uint64_t filesActive;
+    uint64_t queueDepth;
+    uint64_t errors;
+    uint64_t inputBytes;
+    double bytesPerSecond;
+    uint32_t algorithmCount;
+    uint32_t finished;
+    char inputBackend[24];
+    LiveMetricsAlgorithm algorithms[LIVE_METRICS_MAX_ALGORITHMS];
+};
+
+static_assert(sizeof(LiveMetricsBlock) == 768, "live metrics layout is read by external tools");
+
+inline uint64_t unixTimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+class LiveMetrics {
+public:
+    LiveMetrics() {
+        for (auto& bytes : algorithmBytes) bytes.store(0, std::memory_order_relaxed);
+    }
+    ~LiveMetrics() { stop(); }
+
+    LiveMetrics(const LiveMetrics&) = delete;
+    LiveMetrics& operator=(const LiveMetrics&) = delete;
+
+    // Create the metrics file; call addAlgorithm/setInputBackend, then start()
+    bool open(const std::string& metricsPath, std::string& error) {
+        path = metricsPath;
+        memset(&local, 0, sizeof(local));
+        memcpy(local.magic, "HASHMET2", 8);
+#ifdef _WIN32
+        local.pid = (uint64_t)_getpid();
+#else
+        local.pid = (uint64_t)getpid();
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, sizeof(LiveMetricsBlock)) != 0) {
+            error = "cannot create metrics file " + path + ": " + strerror(errno);
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, sizeof(LiveMetricsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            error = "cannot map metrics file " + path + ": " + strerror(errno);
+            return false;
+        }
+        shared = static_cast<LiveMetricsBlock*>(mapping);
+#endif
+        local.startNs = unixTimeNs();
+        opened = true;
+        return true;
+    }
+
+    bool active() const { return opened; }
+
+    // Index for addAlgorithmBytes; algorithms past LIVE_METRICS_MAX_ALGORITHMS are not reported
+    size_t addAlgorithm(const char* name, const char* kernel) {
+        std::lock_guard<std::mutex> lock(localMutex);
+        size_t index = local.algorithmCount;
+        if (index >= LIVE_METRICS_MAX_ALGORITHMS) return index;
+        copyName(local.algorithms[index].name, name, sizeof(local.algorithms[index].name));
+        copyName(local.algorithms[index].kernel, kernel, sizeof(local.algorithms[index].kernel));
+        local.algorithmCount++;
+        return index;
+    }
+
+    void setInputBackend(const char* backend) {
+        std::lock_guard<std::mutex> lock(localMutex);
+        copyName(local.inputBackend, backend, sizeof(local.inputBackend));
+    }
+
+    // Publish every intervalMs until stop()
+    void start(int intervalMs = 250) {
+        if (!opened) return;
+        publish(false);
+        publisher = std::thread([this, intervalMs]() {
+            std::unique_lock<std::mutex> lock(stopMutex);
+            while (!stopping) {
+                stopSignal.wait_for(lock, std::chrono::milliseconds(intervalMs));
+                publish(false);
+            }
+        });
+    }
+
+    // Final snapshot with the finished flag set
+    void stop() {
+        if (!opened) return;
+        if (publisher.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(stopMutex);
+                stopping = true;
+            }
+            stopSignal.notify_all();
+            publisher.join();
+        }
+        publish(true);
+#ifndef _WIN32
+        munmap(shared, sizeof(LiveMetricsBlock));
+        shared = nullptr;
+#endif
+        opened = false;
+    }
+
+    // Hot-path updates: relaxed atomics, safe from any thread
+    void addInputBytes(uint64_t count) { inputBytes.fetch_add(count, std::memory_order_relaxed); }
+    void addAlgorithmBytes(size_t algorithm, uint64_t count) {
+        if (algorithm < LIVE_METRICS_MAX_ALGORITHMS) algorithmBytes[algorithm].fetch_add(count, std::memory_order_relaxed);
+    }
+    void filesQueued(uint64_t count) { queued.fetch_add(count, std::memory_order_relaxed); }
+    void fileStarted() {
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        running.fetch_add(1, std::memory_order_relaxed);
+    }
+    void fileFinished(bool ok) {
+        running.fetch_sub(1, std::memory_order_relaxed);
+        done.fetch_add(1, std::memory_order_relaxed);
+        if (!ok) errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    void addError() { errors.fetch_add(1, std::memory_order_relaxed); }
+    void setQueueDepth(uint64_t depth) { queueDepth.store(depth, std::memory_order_relaxed); }
+
+private:
+    static void copyName(char* target, const char* name, size_t size) {
+        memset(target, 0, size);
+        if (name) strncpy(target, name, size - 1);
+    }
+
+    // Only the publisher thread (or stop() after joining it) calls this
+    void publish(bool finished) {
+        std::lock_guard<std::mutex> lock(localMutex);
+        uint64_t now = unixTimeNs();
+        uint64_t bytes = inputBytes.load(std::memory_order_relaxed);
+        // The final snapshot reports the whole-run average instead
+        uint64_t since = finished ? local.startNs : (lastPublishNs ? lastPublishNs : local.startNs);
+        double seconds = (now - since) * 1e-9;
+        uint64_t delta = finished ? bytes : bytes - lastPublishBytes;
+        local.bytesPerSecond = seconds > 0 ? delta / seconds : 0.0;
+        lastPublishNs = now;
+        lastPublishBytes = bytes;
+
+        local.updateNs = now;
+        local.filesDone = done.load(std::memory_order_relaxed);
+        local.filesQueued = queued.load(std::memory_order_relaxed);
+        local.filesActive = running.load(std::memory_order_relaxed);
+        local.queueDepth = queueDepth.load(std::memory_order_relaxed);
+        local.errors = errors.load(std::memory_order_relaxed);
+        local.inputBytes = bytes;
+        local.finished = finished ? 1 : 0;
+        for (size_t i = 0; i < local.algorithmCount; ++i) {
+            local.algorithms[i].bytes = algorithmBytes[i].load(std::memory_order_relaxed);
+        }
+
+#ifdef _WIN32
+        local.sequence += 2;
+        std::string temporary = path + ".tmp";
+        FILE* out = fopen(temporary.c_str(), "wb");
+        if (!out) return;
+        bool ok = fwrite(&local, sizeof(local), 1, out) == 1;
+        if (fclose(out) != 0 || !ok) return;
+        MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+        // Seqlock write: odd sequence, body, even sequence
+        uint64_t sequence = local.sequence + 1;
+        __atomic_store_n(&shared->sequence, sequence, __ATOMIC_RELAXED);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(shared->magic, local.magic, sizeof(local.magic));
+        memcpy(&shared->pid, &local.pid, sizeof(LiveMetricsBlock) - offsetof(LiveMetricsBlock, pid));
+        local.sequence = sequence + 1;
+        __atomic_store_n(&shared->sequence, local.sequence, __ATOMIC_RELEASE);
+#endif
+    }
+
+    std::string path;
+    bool opened = false;
+    LiveMetricsBlock local;   // Publisher's copy
+    std::mutex localMutex;    // Guards local against backend/algorithm changes mid-run
+    LiveMetricsBlock* shared = nullptr;
+    uint64_t lastPublishNs = 0;
+    uint64_t lastPublishBytes = 0;
+
+    std::atomic<uint64_t> inputBytes{0};
+    std::atomic<uint64_t> algorithmBytes[LIVE_METRICS_MAX_ALGORITHMS];
+    std::atomic<uint64_t> queued{0};
+    std::atomic<uint64_t> running{0};
+    std::atomic<uint64_t> done{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> queueDepth{0};
+
+    std::thread publisher;
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+    bool stopping = false;
+};
+
+#endif
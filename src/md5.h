@@ -0,0 +1,146 @@
+#ifndef MD5_H
+#define MD5_H
+
+#include <cstdint>
+#include <cstddef>
+#include "block_hasher.h"
+#include "cpu_dispatch.h"
+
+// Constants for MD5 transform
+constexpr uint32_t MD5_K[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+// Bitwise rotation
+constexpr uint32_t md5LeftRotate(uint32_t x, uint32_t c) {
+    return (x << c) | (x >> (32 - c));
+}
+
+// MD5 basic functions
+constexpr uint32_t md5F(uint32_t x, uint32_t y, uint32_t z) { return (x & y) | (~x & z); }
+constexpr uint32_t md5G(uint32_t x, uint32_t y, uint32_t z) { return (x & z) | (y & ~z); }
+constexpr uint32_t md5H(uint32_t x, uint32_t y, uint32_t z) { return x ^ y ^ z; }
+constexpr uint32_t md5I(uint32_t x, uint32_t y, uint32_t z) { return y ^ (x | ~z); }
+
+// Little endian word load; compiles to a plain load on x86
+constexpr uint32_t md5LoadWord(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Process a single 64-byte block
+__attribute__((always_inline))
+constexpr void md5Transform(const uint8_t* block, uint32_t state[4]) {
+    uint32_t M[16] = {};
+    for (int i = 0; i < 16; ++i) {
+        M[i] = md5LoadWord(block + i * 4);
+    }
+
+    uint32_t A = state[0];
+    uint32_t B = state[1];
+    uint32_t C = state[2];
+    uint32_t D = state[3];
+
+    // Unrolled rounds
+    #define MD5_STEP(f, a, b, c, d, k, s, i) \
+        a += f(b, c, d) + M[k] + MD5_K[i]; a = b + md5LeftRotate(a, s)
+
+    MD5_STEP(md5F, A, B, C, D, 0, 7, 0); MD5_STEP(md5F, D, A, B, C, 1, 12, 1); MD5_STEP(md5F, C, D, A, B, 2, 17, 2); MD5_STEP(md5F, B, C, D, A, 3, 22, 3);
+    MD5_STEP(md5F, A, B, C, D, 4, 7, 4); MD5_STEP(md5F, D, A, B, C, 5, 12, 5); MD5_STEP(md5F, C, D, A, B, 6, 17, 6); MD5_STEP(md5F, B, C, D, A, 7, 22, 7);
+    MD5_STEP(md5F, A, B, C, D, 8, 7, 8); MD5_STEP(md5F, D, A, B, C, 9, 12, 9); MD5_STEP(md5F, C, D, A, B, 10, 17, 10); MD5_STEP(md5F, B, C, D, A, 11, 22, 11);
+    MD5_STEP(md5F, A, B, C, D, 12, 7, 12); MD5_STEP(md5F, D, A, B, C, 13, 12, 13); MD5_STEP(md5F, C, D, A, B, 14, 17, 14); MD5_STEP(md5F, B, C, D, A, 15, 22, 15);
+
+    MD5_STEP(md5G, A, B, C, D, 1, 5, 16); MD5_STEP(md5G, D, A, B, C, 6, 9, 17); MD5_STEP(md5G, C, D, A, B, 11, 14, 18); MD5_STEP(md5G, B, C, D, A, 0, 20, 19);
+    MD5_STEP(md5G, A, B, C, D, 5, 5, 20); MD5_STEP(md5G, D, A, B, C, 10, 9, 21); MD5_STEP(md5G, C, D, A, B, 15, 14, 22); MD5_STEP(md5G, B, C, D, A, 4, 20, 23);
+    MD5_STEP(md5G, A, B, C, D, 9, 5, 24); MD5_STEP(md5G, D, A, B, C, 14, 9, 25); MD5_STEP(md5G, C, D, A, B, 3, 14, 26); MD5_STEP(md5G, B, C, D, A, 8, 20, 27);
+    MD5_STEP(md5G, A, B, C, D, 13, 5, 28); MD5_STEP(md5G, D, A, B, C, 2, 9, 29); MD5_STEP(md5G, C, D, A, B, 7, 14, 30); MD5_STEP(md5G, B, C, D, A, 12, 20, 31);
+
+    MD5_STEP(md5H, A, B, C, D, 5, 4, 32); MD5_STEP(md5H, D, A, B, C, 8, 11, 33); MD5_STEP(md5H, C, D, A, B, 11, 16, 34); MD5_STEP(md5H, B, C, D, A, 14, 23, 35);
+    MD5_STEP(md5H, A, B, C, D, 1, 4, 36); MD5_STEP(md5H, D, A, B, C, 4, 11, 37); MD5_STEP(md5H, C, D, A, B, 7, 16, 38); MD5_STEP(md5H, B, C, D, A, 10, 23, 39);
+    MD5_STEP(md5H, A, B, C, D, 13, 4, 40); MD5_STEP(md5H, D, A, B, C, 0, 11, 41); MD5_STEP(md5H, C, D, A, B, 3, 16, 42); MD5_STEP(md5H, B, C, D, A, 6, 23, 43);
+    MD5_STEP(md5H, A, B, C, D, 9, 4, 44); MD5_STEP(md5H, D, A, B, C, 12, 11, 45); MD5_STEP(md5H, C, D, A, B, 15, 16, 46); MD5_STEP(md5H, B, C, D, A, 2, 23, 47);
+
+    MD5_STEP(md5I, A, B, C, D, 0, 6, 48); MD5_STEP(md5I, D, A, B, C, 7, 10, 49); MD5_STEP(md5I, C, D, A, B, 14, 15, 50); MD5_STEP(md5I, B, C, D, A, 5, 21, 51);
+    MD5_STEP(md5I, A, B, C, D, 12, 6, 52); MD5_STEP(md5I, D, A, B, C, 3, 10, 53); MD5_STEP(md5I, C, D, A, B, 10, 15, 54); MD5_STEP(md5I, B, C, D, A, 1, 21, 55);
+    MD5_STEP(md5I, A, B, C, D, 8, 6, 56); MD5_STEP(md5I, D, A, B, C, 15, 10, 57); MD5_STEP(md5I, C, D, A, B, 6, 15, 58); MD5_STEP(md5I, B, C, D, A, 13, 21, 59);
+    MD5_STEP(md5I, A, B, C, D, 4, 6, 60); MD5_STEP(md5I, D, A, B, C, 11, 10, 61); MD5_STEP(md5I, C, D, A, B, 2, 15, 62); MD5_STEP(md5I, B, C, D, A, 9, 21, 63);
+
+    #undef MD5_STEP
+
+    state[0] += A;
+    state[1] += B;
+    state[2] += C;
+    state[3] += D;
+}
+
+// Process consecutive whole blocks
+constexpr void md5Blocks(const uint8_t* data, size_t blockCount, uint32_t state[4]) {
+    for (size_t i = 0; i < blockCount; ++i) {
+        md5Transform(data + i * 64, state);
+    }
+}
+
+typedef void (*Md5BlocksFunction)(const uint8_t*, size_t, uint32_t*);
+
+#if HASH_X86
+// MD5 is a serial dependency chain; only BMI (andn) helps, no SIMD variant
+HASH_TARGET("avx2,bmi,bmi2") __attribute__((flatten))
+inline void md5BlocksAvx2(const uint8_t* data, size_t blockCount, uint32_t* state) {
+    md5Blocks(data, blockCount, state);
+}
+#endif
+
+inline KernelDispatch<Md5BlocksFunction>& md5Dispatch() {
+    static KernelDispatch<Md5BlocksFunction> dispatch("MD5", {
+        {"scalar", true, md5Blocks},
+#if HASH_X86
+        {"avx2", cpuFeatures().avx2, md5BlocksAvx2},
+#endif
+    });
+    return dispatch;
+}
+
+// Incremental MD5 hasher
+class Md5 : public BlockHasher<Md5, 64, 8, false, 16> {
+public:
+    constexpr Md5() {
+        reset();
+    }
+
+    constexpr void resetState() {
+        state[0] = 0x67452301;
+        state[1] = 0xefcdab89;
+        state[2] = 0x98badcfe;
+        state[3] = 0x10325476;
+    }
+
+    constexpr void processBlocks(const uint8_t* data, size_t blockCount) {
+        if (__builtin_is_constant_evaluated()) {
+            md5Blocks(data, blockCount, state);
+            return;
+        }
+        md5Dispatch().function()(data, blockCount, state);
+    }
+
+    static KernelDispatch<Md5BlocksFunction>& dispatch() {
+        return md5Dispatch();
+    }
+
+    // Little endian state words
+    constexpr void writeDigest(uint8_t* out) const {
+        for (int i = 0; i < 16; ++i) {
+            out[i] = (state[i / 4] >> ((i % 4) * 8)) & 0xFF;
+        }
+    }
+
+private:
+    uint32_t state[4] = {};
+};
+
+#endif
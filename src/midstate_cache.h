@@ -0,0 +1,127 @@
+#ifndef MIDSTATE_CACHE_H
+#define MIDSTATE_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "hash_registry.h"
+
+// Digest of a buffer that changes a little between calls (a text box being
+// edited). Hasher snapshots are kept at block boundaries of the last input;
+// the next call compares against that input, drops the snapshots past the
+// first changed byte and resumes from the last one before it. Typing at the
+// end of a large document then costs a few compression calls instead of a
+// pass over the whole text. Finding the change is a memcmp against the copy
+// of the last input, several times cheaper than hashing the same bytes.
+//
+// Snapshots start one block (at least 64 bytes) apart; the spacing doubles
+// whenever there would be more than MAX_CHECKPOINTS, and halves again when an
+// edit makes the text short enough. Each snapshot is a heap-allocated hasher
+// clone (about 130 B for SHA-256, 230 B for SHA-512 with allocator overhead),
+// so the snapshots take at most about 0.5-1 MiB per algorithm, plus a copy of
+// the last input.
+
+class MidstateCache {
+public:
+    static constexpr size_t MAX_CHECKPOINTS = 4096;
+
+    explicit MidstateCache(const AlgorithmInfo& info)
+        : prototype(info.create()), initialSpacing(std::max<size_t>(info.blockSize, 64)),
+          spacing(initialSpacing) {}
+
+    const char* name() const { return prototype->name(); }
+    size_t digestSize() const { return prototype->digestSize(); }
+
+    // Offset hashing resumed from on the last call (0 when nothing was reused)
+    size_t resumedFrom() const { return resumeOffset; }
+
+    // Forget the previous input
+    void clear() {
+        input.clear();
+        checkpoints.clear();
+        spacing = initialSpacing;
+    }
+
+    // Digest of data[0..length), reusing the previous call's work
+    void digest(const uint8_t* data, size_t length, uint8_t* out) {
+        size_t shared = commonPrefix(data, length);
+
+        // Snapshots past the first changed byte are stale
+        while (!checkpoints.empty() && checkpoints.back().first > shared) checkpoints.pop_back();
+
+        std::unique_ptr<DynamicHasher> hasher;
+        if (checkpoints.empty()) {
+            spacing = initialSpacing;
+            hasher = prototype->clone();
+            hasher->reset();
+            resumeOffset = 0;
+        } else {
+            // After the text shrinks, a finer grid fits again; the kept
+            // snapshots lie on it too, since spacings are powers of two apart
+            spacing = std::min(spacing, spacingFor(length));
+            hasher = checkpoints.back().second->clone();
+            resumeOffset = checkpoints.back().first;
+        }
+
+        // Hash the rest, snapshotting at each spacing boundary
+        size_t offset = resumeOffset;
+        while (length - offset >= spacing - offset % spacing) {
+            size_t step = spacing - offset % spacing;
+            hasher->update(data + offset, step);
+            offset += step;
+            checkpoints.emplace_back(offset, hasher->clone());
+            if (checkpoints.size() > MAX_CHECKPOINTS) thin();
+        }
+        hasher->update(data + offset, length - offset);
+        hasher->finalize(out);
+
+        // Only the changed tail needs copying
+        input.resize(length);
+        if (length > shared) memcpy(input.data() + shared, data + shared, length - shared);
+    }
+
+private:
+    size_t commonPrefix(const uint8_t* data, size_t length) const {
+        size_t limit = std::min(length, input.size());
+        // Compare in 4 KiB pieces so an early change is found without scanning the rest
+        const size_t PIECE = 4096;
+        size_t shared = 0;
+        while (shared < limit) {
+            size_t piece = std::min(PIECE, limit - shared);
+            if (memcmp(data + shared, input.data() + shared, piece) != 0) break;
+            shared += piece;
+        }
+        while (shared < limit && data[shared] == input[shared]) ++shared;
+        return shared;
+    }
+
+    // Finest spacing at which an input of `length` needs no thinning
+    size_t spacingFor(size_t length) const {
+        size_t result = initialSpacing;
+        while (length / result > MAX_CHECKPOINTS) result *= 2;
+        return result;
+    }
+
+    // Double the spacing and keep only the snapshots on the new grid
+    void thin() {
+        spacing *= 2;
+        size_t kept = 0;
+        for (auto& checkpoint : checkpoints) {
+            if (checkpoint.first % spacing == 0) checkpoints[kept++] = std::move(checkpoint);
+        }
+        checkpoints.resize(kept);
+    }
+
+    std::unique_ptr<DynamicHasher> prototype;
+    size_t initialSpacing;
+    size_t spacing;   // Bytes between snapshots, a multiple of the block size
+    std::vector<uint8_t> input;
+    std::vector<std::pair<size_t, std::unique_ptr<DynamicHasher>>> checkpoints;   // Ascending offsets
+    size_t resumeOffset = 0;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+// Hardware performance counters around the engine's hot loops.
+// One perf_event_open group per process (user space only, so it works at
+// perf_event_paranoid <= 2), read with a single syscall per stage boundary.
+// Events the CPU or hypervisor does not expose are reported as null; the
+// software task clock is always there. Other platforms get wall time only.
+
+enum PerfEvent {
+    PERF_TASK_CLOCK,
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_EVENT_COUNT
+};
+
+constexpr const char* PERF_EVENT_NAMES[PERF_EVENT_COUNT] = {
+    "task_clock_ns", "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+struct PerfValues {
+    uint64_t value[PERF_EVENT_COUNT] = {};
+};
+
+class PerfCounters {
+public:
+    PerfCounters() {
+#ifdef __linux__
+        const uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint64_t llcReadMiss = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const struct { uint32_t type; uint64_t config; } EVENTS[PERF_EVENT_COUNT] = {
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, l1dReadMiss},
+            {PERF_TYPE_HW_CACHE, llcReadMiss},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+
+        for (int event = 0; event < PERF_EVENT_COUNT; ++event) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = EVENTS[event].type;
+            attr.config = EVENTS[event].config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+            if (fd < 0) {
+                if (error.empty() && event != PERF_TASK_CLOCK) {
+                    error = std::string(PERF_EVENT_NAMES[event]) + ": " + strerror(errno);
+                }
+                continue;
+            }
+            if (leader < 0) leader = fd;
+            fds.push_back(fd);
+            slots.push_back(event);
+            opened[event] = true;
+        }
+#else
+        error = "perf_event_open is Linux only";
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds) close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(int event) const { return opened[event]; }
+    bool hardware() const { return opened[PERF_CYCLES]; }
+    const std::string& lastError() const { return error; }
+
+    // Running totals of every open event
+    PerfValues read() const {
+        PerfValues values;
+#ifdef __linux__
+        if (leader < 0) return values;
+        uint64_t buffer[1 + PERF_EVENT_COUNT] = {};
+        if (::read(leader, buffer, sizeof(buffer)) <= 0) return values;
+        for (size_t i = 0; i < slots.size() && i < buffer[0]; ++i) {
+            values.value[slots[i]] = buffer[1 + i];
+        }
+#endif
+        return values;
+    }
+
+private:
+    int leader = -1;
+    std::vector<int> fds;
+    std::vector<int> slots;   // Event of each group member, in read order
+    bool opened[PERF_EVENT_COUNT] = {};
+    std::string error;
+};
+
+// Attributes counter deltas to named stages. mark() charges everything since
+// the previous mark to one stage, so consecutive stages cost one read each.
+class StageProfiler {
+public:
+    size_t addStage(const std::string& name) {
+        stages.push_back({name, PerfValues(), 0.0, 0});
+        return stages.size() - 1;
+    }
+
+    void begin() {
+        last = counters.read();
+        lastTime = std::chrono::steady_clock::now();
+    }
+
+    void mark(size_t stage, uint64_t bytes) {
+        PerfValues now = counters.read();
+        auto nowTime = std::chrono::steady_clock::now();
+        Stage& s = stages[stage];
+        for (int event = 0; event < PERF_EVENT_COUNT; ++event) {
+            s.totals.value[event] += now.value[event] - last.value[event];
+        }
+        s.seconds += std::chrono::duration<double>(nowTime - lastTime).count();
+        s.bytes += bytes;
+        last = now;
+        lastTime = nowTime;
+    }
+
+    // One-line JSON report: per stage raw counts, IPC and cycles/byte
+    std::string json() const {
+        std::string out = "{\"perf\":{\"hardware\":";
+        out += counters.hardware() ? "true" : "false";
+        if (!counters.lastError().empty()) out += ",\"error\":\"" + counters.lastError() + "\"";
+        out += ",\"stages\":[";
+        for (size_t i = 0; i < stages.size(); ++i) {
+            const Stage& s = stages[i];
+            char number[64];
+            if (i > 0) out += ',';
+            out += "{\"stage\":\"" + s.name + "\"";
+            out += ",\"bytes\":" + std::to_string(s.bytes);
+            snprintf(number, sizeof(number), "%.6f", s.seconds);
+            out += ",\"seconds\":" + std::string(number);
+            for (int event = 0; event < PERF_EVENT_COUNT; ++event) {
+                out += ",\"" + std::string(PERF_EVENT_NAMES[event]) + "\":";
+                out += counters.available(event) ? std::to_string(s.totals.value[event]) : "null";
+            }
+
+            uint64_t cycles = s.totals.value[PERF_CYCLES];
+            out += ",\"ipc\":";
+            if (counters.available(PERF_CYCLES) && counters.available(PERF_INSTRUCTIONS) && cycles > 0) {
+                snprintf(number, sizeof(number), "%.3f", (double)s.totals.value[PERF_INSTRUCTIONS] / cycles);
+                out += number;
+            } else {
+                out += "null";
+            }
+            out += ",\"cycles_per_byte\":";
+            if (counters.available(PERF_CYCLES) && s.bytes > 0) {
+                snprintf(number, sizeof(number), "%.4f", (double)cycles / s.bytes);
+                out += number;
+            } else {
+                out += "null";
+            }
+            out += '}';
+        }
+        out += "]}}";
+        return out;
+    }
+
+private:
+    struct Stage {
+        std::string name;
+        PerfValues totals;
+        double seconds;
+        uint64_t bytes;
+    };
+
+    PerfCounters counters;
+    std::vector<Stage> stages;
+    PerfValues last;
+    std::chrono::steady_clock::time_point lastTime;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <cstdint>
+#include <cstddef>
+#include "block_hasher.h"
+#include "cpu_dispatch.h"
+
+// SHA-1 Circular Rotate Left
+constexpr uint32_t sha1LeftRotate(uint32_t x, uint32_t c) {
+    return (x << c) | (x >> (32 - c));
+}
+
+// Process a single 64-byte block
+__attribute__((always_inline))
+constexpr void sha1Transform(const uint8_t* block, uint32_t state[5]) {
+    uint32_t w[80] = {};
+
+    // Word loading (Big Endian)
+    for (int j = 0; j < 16; ++j) {
+        w[j] = ((uint32_t)block[j * 4] << 24) | ((uint32_t)block[j * 4 + 1] << 16) |
+               ((uint32_t)block[j * 4 + 2] << 8) | block[j * 4 + 3];
+    }
+
+    // Extend to 80 words
+    for (int j = 16; j < 80; ++j) {
+        w[j] = sha1LeftRotate(w[j - 3] ^ w[j - 8] ^ w[j - 14] ^ w[j - 16], 1);
+    }
+
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+
+    // Round 1: 0-19
+    for (int j = 0; j < 20; ++j) {
+        uint32_t f = (b & c) | ((~b) & d);
+        uint32_t temp = sha1LeftRotate(a, 5) + f + e + 0x5A827999 + w[j];
+        e = d; d = c; c = sha1LeftRotate(b, 30); b = a; a = temp;
+    }
+
+    // Round 2: 20-39
+    for (int j = 20; j < 40; ++j) {
+        uint32_t f = b ^ c ^ d;
+        uint32_t temp = sha1LeftRotate(a, 5) + f + e + 0x6ED9EBA1 + w[j];
+        e = d; d = c; c = sha1LeftRotate(b, 30); b = a; a = temp;
+    }
+
+    // Round 3: 40-59
+    for (int j = 40; j < 60; ++j) {
+        uint32_t f = (b & c) | (b & d) | (c & d);
+        uint32_t temp = sha1LeftRotate(a, 5) + f + e + 0x8F1BBCDC + w[j];
+        e = d; d = c; c = sha1LeftRotate(b, 30); b = a; a = temp;
+    }
+
+    // Round 4: 60-79
+    for (int j = 60; j < 80; ++j) {
+        uint32_t f = b ^ c ^ d;
+        uint32_t temp = sha1LeftRotate(a, 5) + f + e + 0xCA62C1D6 + w[j];
+        e = d; d = c; c = sha1LeftRotate(b, 30); b = a; a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+// Process consecutive whole blocks
+constexpr void sha1Blocks(const uint8_t* data, size_t blockCount, uint32_t state[5]) {
+    for (size_t i = 0; i < blockCount; ++i) {
+        sha1Transform(data + i * 64, state);
+    }
+}
+
+typedef void (*Sha1BlocksFunction)(const uint8_t*, size_t, uint32_t*);
+
+#if HASH_X86
+// Generic transform recompiled with BMI2 (rorx/andn)
+HASH_TARGET("avx2,bmi,bmi2") __attribute__((flatten))
+inline void sha1BlocksAvx2(const uint8_t* data, size_t blockCount, uint32_t* state) {
+    sha1Blocks(data, blockCount, state);
+}
+
+// SHA-1 with the SHA extensions: four rounds per sha1rnds4, E carried
+// alternately in two registers, schedule extended three groups ahead
+HASH_TARGET("sha,sse4.1")
+inline void sha1BlocksShaNi(const uint8_t* data, size_t blockCount, uint32_t* state) {
+    // Reverses all 16 bytes: big endian words, W0 in the top lane
+    const __m128i BYTE_SWAP = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1B);
+    __m128i e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+    for (size_t block = 0; block < blockCount; ++block, data += 64) {
+        __m128i abcdSave = abcd;
+        __m128i e0Save = e0;
+        __m128i e1 = _mm_setzero_si128();
+        __m128i m[4];
+
+        #pragma GCC unroll 20
+        for (int g = 0; g < 20; ++g) {
+            __m128i& current = m[g & 3];
+            __m128i& e = (g & 1) ? e1 : e0;
+            __m128i& other = (g & 1) ? e0 : e1;
+
+            if (g < 4) {
+                current = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + g * 16)), BYTE_SWAP);
+            }
+            e = g == 0 ? _mm_add_epi32(e, current) : _mm_sha1nexte_epu32(e, current);
+            other = abcd;
+            if (g >= 3 && g <= 18) {
+                m[(g + 1) & 3] = _mm_sha1msg2_epu32(m[(g + 1) & 3], current);
+            }
+            switch (g / 5) {
+                case 0: abcd = _mm_sha1rnds4_epu32(abcd, e, 0); break;
+                case 1: abcd = _mm_sha1rnds4_epu32(abcd, e, 1); break;
+                case 2: abcd = _mm_sha1rnds4_epu32(abcd, e, 2); break;
+                default: abcd = _mm_sha1rnds4_epu32(abcd, e, 3); break;
+            }
+            if (g >= 1 && g <= 16) {
+                m[(g + 3) & 3] = _mm_sha1msg1_epu32(m[(g + 3) & 3], current);
+            }
+            if (g >= 2 && g <= 17) {
+                m[(g + 2) & 3] = _mm_xor_si128(m[(g + 2) & 3], current);
+            }
+        }
+
+        e0 = _mm_sha1nexte_epu32(e0, e0Save);
+        abcd = _mm_add_epi32(abcd, abcdSave);
+    }
+
+    _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+#endif
+
+inline KernelDispatch<Sha1BlocksFunction>& sha1Dispatch() {
+    static KernelDispatch<Sha1BlocksFunction> dispatch("SHA-1", {
+        {"scalar", true, sha1Blocks},
+#if HASH_X86
+        {"avx2", cpuFeatures().avx2, sha1BlocksAvx2},
+        {"sha-ni", cpuFeatures().shaNi, sha1BlocksShaNi},
+#endif
+    });
+    return dispatch;
+}
+
+// Incremental SHA-1 hasher
+class Sha1 : public BlockHasher<Sha1, 64, 8, true, 20> {
+public:
+    constexpr Sha1() {
+        reset();
+    }
+
+    constexpr void resetState() {
+        state[0] = 0x67452301;
+        state[1] = 0xEFCDAB89;
+        state[2] = 0x98BADCFE;
+        state[3] = 0x10325476;
+        state[4] = 0xC3D2E1F0;
+    }
+
+    constexpr void processBlocks(const uint8_t* data, size_t blockCount) {
+        if (__builtin_is_constant_evaluated()) {
+            sha1Blocks(data, blockCount, state);
+            return;
+        }
+        sha1Dispatch().function()(data, blockCount, state);
+    }
+
+    static KernelDispatch<Sha1BlocksFunction>& dispatch() {
+        return sha1Dispatch();
+    }
+
+    // Big endian state words
+    constexpr void writeDigest(uint8_t* out) const {
+        for (int i = 0; i < 20; ++i) {
+            out[i] = (state[i / 4] >> ((3 - i % 4) * 8)) & 0xFF;
+        }
+    }
+
+private:
+    uint32_t state[5] = {};
+};
+
+#endif
@@ -0,0 +1,369 @@
+#ifndef SHA2_H
+#define SHA2_H
+
+#include <cstdint>
+#include <cstddef>
+#include "block_hasher.h"
+#include "cpu_dispatch.h"
+
+// SHA-2 word-size families.
+// A family fixes the word type, round count, round constants and the
+// rotation amounts of the compression function. Variants built on the same
+// family share one transform, so any kernel added here serves all of them.
+
+// SHA-224 / SHA-256: 32-bit words, 64 rounds, 64-byte blocks
+struct Sha2Family32 {
+    typedef Sha2Family32 Family;
+    typedef uint32_t Word;
+    static constexpr int ROUNDS = 64;
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr size_t LENGTH_SIZE = 8;   // Message length field in bytes
+    static constexpr const char* KERNEL_NAME = "SHA-256";   // Dispatch table name
+
+    // Rotation/shift amounts for Sigma0, Sigma1, sigma0, sigma1
+    static constexpr int BIG_S0[3] = {2, 13, 22};
+    static constexpr int BIG_S1[3] = {6, 11, 25};
+    static constexpr int SMALL_S0[3] = {7, 18, 3};
+    static constexpr int SMALL_S1[3] = {17, 19, 10};
+
+    static constexpr Word K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+};
+
+// SHA-384 / SHA-512 / SHA-512/t: 64-bit words, 80 rounds, 128-byte blocks
+struct Sha2Family64 {
+    typedef Sha2Family64 Family;
+    typedef uint64_t Word;
+    static constexpr int ROUNDS = 80;
+    static constexpr size_t BLOCK_SIZE = 128;
+    static constexpr size_t LENGTH_SIZE = 16;
+    static constexpr const char* KERNEL_NAME = "SHA-512";
+
+    static constexpr int BIG_S0[3] = {28, 34, 39};
+    static constexpr int BIG_S1[3] = {14, 18, 41};
+    static constexpr int SMALL_S0[3] = {1, 8, 7};
+    static constexpr int SMALL_S1[3] = {19, 61, 6};
+
+    static constexpr Word K[80] = {
+        0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+        0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+        0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+        0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+        0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+        0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+        0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+        0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+        0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+        0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+        0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+        0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+        0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+        0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+        0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+        0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+        0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+        0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+        0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+        0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+    };
+};
+
+// SHA-2 variants: a family plus its initial hash values and digest length.
+// The digest length is given in bytes because SHA-512/224 truncates mid-word.
+
+struct Sha224Traits : Sha2Family32 {
+    static constexpr Word IV[8] = {
+        0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+        0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4
+    };
+    static constexpr size_t DIGEST_SIZE = 28;
+};
+
+struct Sha256Traits : Sha2Family32 {
+    static constexpr Word IV[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    static constexpr size_t DIGEST_SIZE = 32;
+};
+
+struct Sha384Traits : Sha2Family64 {
+    static constexpr Word IV[8] = {
+        0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+        0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+    };
+    static constexpr size_t DIGEST_SIZE = 48;
+};
+
+struct Sha512Traits : Sha2Family64 {
+    static constexpr Word IV[8] = {
+        0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+        0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+    };
+    static constexpr size_t DIGEST_SIZE = 64;
+};
+
+// SHA-512/t IVs are defined by FIPS 180-4 section 5.3.6
+struct Sha512_224Traits : Sha2Family64 {
+    static constexpr Word IV[8] = {
+        0x8c3d37c819544da2ULL, 0x73e1996689dcd4d6ULL, 0x1dfab7ae32ff9c82ULL, 0x679dd514582f9fcfULL,
+        0x0f6d2b697bd44da8ULL, 0x77e36f7304c48942ULL, 0x3f9d85a86a1d36c8ULL, 0x1112e6ad91d692a1ULL
+    };
+    static constexpr size_t DIGEST_SIZE = 28;
+};
+
+struct Sha512_256Traits : Sha2Family64 {
+    static constexpr Word IV[8] = {
+        0x22312194fc2bf72cULL, 0x9f555fa3c84c64c2ULL, 0x2393b86b6f53b151ULL, 0x963877195940eabdULL,
+        0x96283ee2a88effe3ULL, 0xbe5e1e2553863992ULL, 0x2b0199fc2c85b8aaULL, 0x0eb72ddc81c52ca2ULL
+    };
+    static constexpr size_t DIGEST_SIZE = 32;
+};
+
+// Compression function shared by every variant of a family
+template <typename Family>
+struct Sha2Core {
+    typedef typename Family::Word Word;
+
+    static constexpr Word rightRotate(Word x, int c) {
+        return (x >> c) | (x << (sizeof(Word) * 8 - c));
+    }
+
+    static constexpr Word loadBigEndian(const uint8_t* p) {
+        Word value = 0;
+        for (size_t i = 0; i < sizeof(Word); ++i) {
+            value = (value << 8) | p[i];
+        }
+        return value;
+    }
+
+    // Process a single block
+    __attribute__((always_inline))
+    static constexpr void transform(const uint8_t* block, Word H[8]) {
+        Word w[Family::ROUNDS] = {};
+
+        // Prepare message schedule
+        for (int i = 0; i < 16; ++i) {
+            w[i] = loadBigEndian(block + i * sizeof(Word));
+        }
+
+        for (int i = 16; i < Family::ROUNDS; ++i) {
+            Word s0 = rightRotate(w[i - 15], Family::SMALL_S0[0]) ^ rightRotate(w[i - 15], Family::SMALL_S0[1]) ^ (w[i - 15] >> Family::SMALL_S0[2]);
+            Word s1 = rightRotate(w[i - 2], Family::SMALL_S1[0]) ^ rightRotate(w[i - 2], Family::SMALL_S1[1]) ^ (w[i - 2] >> Family::SMALL_S1[2]);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        Word a = H[0];
+        Word b = H[1];
+        Word c = H[2];
+        Word d = H[3];
+        Word e = H[4];
+        Word f = H[5];
+        Word g = H[6];
+        Word h = H[7];
+
+        for (int i = 0; i < Family::ROUNDS; ++i) {
+            Word S1 = rightRotate(e, Family::BIG_S1[0]) ^ rightRotate(e, Family::BIG_S1[1]) ^ rightRotate(e, Family::BIG_S1[2]);
+            Word ch = (e & f) ^ (~e & g);
+            Word temp1 = h + S1 + ch + Family::K[i] + w[i];
+            Word S0 = rightRotate(a, Family::BIG_S0[0]) ^ rightRotate(a, Family::BIG_S0[1]) ^ rightRotate(a, Family::BIG_S0[2]);
+            Word maj = (a & b) ^ (a & c) ^ (b & c);
+            Word temp2 = S0 + maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        H[0] += a;
+        H[1] += b;
+        H[2] += c;
+        H[3] += d;
+        H[4] += e;
+        H[5] += f;
+        H[6] += g;
+        H[7] += h;
+    }
+
+    // Process consecutive whole blocks
+    static constexpr void processBlocks(const uint8_t* data, size_t blockCount, Word H[8]) {
+        for (size_t i = 0; i < blockCount; ++i) {
+            transform(data + i * Family::BLOCK_SIZE, H);
+        }
+    }
+};
+
+// Signature shared by every SHA-2 kernel variant
+template <typename Family>
+using Sha2BlocksFunction = void (*)(const uint8_t*, size_t, typename Family::Word*);
+
+#if HASH_X86
+// The generic compression function recompiled for wider ISAs: BMI2 gives
+// rorx/andn, AVX-512 lets the compiler vectorise the message schedule
+template <typename Family>
+HASH_TARGET("sse4.1") __attribute__((flatten))
+void sha2BlocksSse41(const uint8_t* data, size_t blockCount, typename Family::Word* H) {
+    Sha2Core<Family>::processBlocks(data, blockCount, H);
+}
+
+template <typename Family>
+HASH_TARGET("avx2,bmi,bmi2") __attribute__((flatten))
+void sha2BlocksAvx2(const uint8_t* data, size_t blockCount, typename Family::Word* H) {
+    Sha2Core<Family>::processBlocks(data, blockCount, H);
+}
+
+template <typename Family>
+HASH_TARGET("avx512f,avx512vl,bmi,bmi2") __attribute__((flatten))
+void sha2BlocksAvx512(const uint8_t* data, size_t blockCount, typename Family::Word* H) {
+    Sha2Core<Family>::processBlocks(data, blockCount, H);
+}
+
+// SHA-256 with the SHA extensions. The state is kept as ABEF/CDGH halves,
+// the layout sha256rnds2 expects; each group of four rounds also extends
+// the message schedule for the group three ahead.
+HASH_TARGET("sha,sse4.1")
+inline void sha256BlocksShaNi(const uint8_t* data, size_t blockCount, uint32_t* H) {
+    const __m128i BYTE_SWAP = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&H[0]), 0xB1);      // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&H[4]), 0x1B);   // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);                                   // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);                                        // CDGH
+
+    for (size_t block = 0; block < blockCount; ++block, data += 64) {
+        __m128i abefSave = state0;
+        __m128i cdghSave = state1;
+        __m128i m[4];
+
+        #pragma GCC unroll 16
+        for (int g = 0; g < 16; ++g) {
+            __m128i& current = m[g & 3];
+            __m128i& next = m[(g + 1) & 3];
+            __m128i& previous = m[(g + 3) & 3];
+
+            if (g < 4) {
+                current = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + g * 16)), BYTE_SWAP);
+            }
+            __m128i message = _mm_add_epi32(current, _mm_loadu_si128((const __m128i*)&Sha2Family32::K[g * 4]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+            if (g >= 3 && g <= 14) {
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, previous, 4));
+                next = _mm_sha256msg2_epu32(next, current);
+            }
+            message = _mm_shuffle_epi32(message, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+            if (g >= 1 && g <= 12) {
+                previous = _mm_sha256msg1_epu32(previous, current);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);          // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);       // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);    // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       // HGFE
+    _mm_storeu_si128((__m128i*)&H[0], state0);
+    _mm_storeu_si128((__m128i*)&H[4], state1);
+}
+#endif
+
+template <typename Family>
+std::vector<KernelVariant<Sha2BlocksFunction<Family>>> sha2Variants();
+
+template <>
+inline std::vector<KernelVariant<Sha2BlocksFunction<Sha2Family32>>> sha2Variants<Sha2Family32>() {
+    return {
+        {"scalar", true, Sha2Core<Sha2Family32>::processBlocks},
+#if HASH_X86
+        {"sse4.1", cpuFeatures().sse41, sha2BlocksSse41<Sha2Family32>},
+        {"avx2", cpuFeatures().avx2, sha2BlocksAvx2<Sha2Family32>},
+        {"avx512", cpuFeatures().avx512, sha2BlocksAvx512<Sha2Family32>},
+        {"sha-ni", cpuFeatures().shaNi, sha256BlocksShaNi},
+#endif
+    };
+}
+
+// The SHA-512 instructions are too new to target, so only the recompiled variants
+template <>
+inline std::vector<KernelVariant<Sha2BlocksFunction<Sha2Family64>>> sha2Variants<Sha2Family64>() {
+    return {
+        {"scalar", true, Sha2Core<Sha2Family64>::processBlocks},
+#if HASH_X86
+        {"sse4.1", cpuFeatures().sse41, sha2BlocksSse41<Sha2Family64>},
+        {"avx2", cpuFeatures().avx2, sha2BlocksAvx2<Sha2Family64>},
+        {"avx512", cpuFeatures().avx512, sha2BlocksAvx512<Sha2Family64>},
+#endif
+    };
+}
+
+// One dispatch table per family, shared by all its variants
+template <typename Family>
+KernelDispatch<Sha2BlocksFunction<Family>>& sha2Dispatch() {
+    static KernelDispatch<Sha2BlocksFunction<Family>> dispatch(Family::KERNEL_NAME, sha2Variants<Family>());
+    return dispatch;
+}
+
+// Incremental SHA-2 hasher
+template <typename Traits>
+class Sha2 : public BlockHasher<Sha2<Traits>, Traits::BLOCK_SIZE, Traits::LENGTH_SIZE, true, Traits::DIGEST_SIZE> {
+public:
+    typedef typename Traits::Word Word;
+    typedef Sha2Core<typename Traits::Family> Core;
+
+    constexpr Sha2() {
+        this->reset();
+    }
+
+    constexpr void resetState() {
+        for (int i = 0; i < 8; ++i) {
+            H[i] = Traits::IV[i];
+        }
+    }
+
+    constexpr void processBlocks(const uint8_t* data, size_t blockCount) {
+        if (__builtin_is_constant_evaluated()) {
+            Core::processBlocks(data, blockCount, H);
+            return;
+        }
+        sha2Dispatch<typename Traits::Family>().function()(data, blockCount, H);
+    }
+
+    static KernelDispatch<Sha2BlocksFunction<typename Traits::Family>>& dispatch() {
+        return sha2Dispatch<typename Traits::Family>();
+    }
+
+    // Big endian state, truncated to DIGEST_SIZE
+    constexpr void writeDigest(uint8_t* out) const {
+        for (size_t i = 0; i < Traits::DIGEST_SIZE; ++i) {
+            out[i] = (H[i / sizeof(Word)] >> ((sizeof(Word) - 1 - i % sizeof(Word)) * 8)) & 0xFF;
+        }
+    }
+
+private:
+    Word H[8] = {};
+};
+
+typedef Sha2<Sha224Traits> Sha224;
+typedef Sha2<Sha256Traits> Sha256;
+typedef Sha2<Sha384Traits> Sha384;
+typedef Sha2<Sha512Traits> Sha512;
+typedef Sha2<Sha512_224Traits> Sha512_224;
+typedef Sha2<Sha512_256Traits> Sha512_256;
+
+#endif
@@ -0,0 +1,143 @@
+// libshahash: the C ABI declared in shahash.h, over the same header-only
+// cores as the executables. Build with hidden visibility and the version
+// script so only the shahash_* entry points are exported:
+//
+//   g++ -O3 -shared -fPIC -fvisibility=hidden -Wl,-soname,libshahash.so.1 -Wl,--version-script=src/shahash.map -o bin/libshahash.so.1 src/shahash.cpp
+
+#define SHAHASH_BUILD
+#include "shahash.h"
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+#include "hash_registry.h"
+#include "sha2_multibuffer.h"
+
+using namespace std;
+
+struct shahash_ctx {
+    unique_ptr<DynamicHasher> hasher;
+};
+
+// Kernel choice follows the host tuning profile, as in the executables
+static const vector<AlgorithmInfo>& algorithms() {
+    static const bool tuned = (applyTunedKernels(), true);
+    (void)tuned;
+    return allAlgorithms();
+}
+
+static const AlgorithmInfo* findAlgorithm(const char* name) {
+    if (!name) return nullptr;
+    for (const AlgorithmInfo& info : algorithms()) {
+        if (strcmp(name, info.name) == 0) return &info;
+    }
+    return nullptr;
+}
+
+extern "C" {
+
+uint32_t shahash_abi_version(void) {
+    return SHAHASH_ABI_VERSION;
+}
+
+size_t shahash_algorithm_count(void) {
+    return algorithms().size();
+}
+
+const char* shahash_algorithm_name(size_t index) {
+    return index < algorithms().size() ? algorithms()[index].name : nullptr;
+}
+
+size_t shahash_digest_size(const char* algorithm) {
+    const AlgorithmInfo* info = findAlgorithm(algorithm);
+    return info ? info->digestSize : 0;
+}
+
+const char* shahash_backend(const char* algorithm) {
+    const AlgorithmInfo* info = findAlgorithm(algorithm);
+    return info ? info->kernels().backend() : nullptr;
+}
+
+shahash_ctx* shahash_new(const char* algorithm) {
+    const AlgorithmInfo* info = findAlgorithm(algorithm);
+    if (!info) return nullptr;
+    try {
+        return new shahash_ctx{info->create()};
+    } catch (const bad_alloc&) {
+        return nullptr;
+    }
+}
+
+shahash_ctx* shahash_copy(const shahash_ctx* ctx) {
+    if (!ctx) return nullptr;
+    try {
+        return new shahash_ctx{ctx->hasher->clone()};
+    } catch (const bad_alloc&) {
+        return nullptr;
+    }
+}
+
+int shahash_update(shahash_ctx* ctx, const void* data, size_t length) {
+    if (!ctx || (!data && length > 0)) return SHAHASH_ERROR_ARGUMENT;
+    ctx->hasher->update((const uint8_t*)data, length);
+    return SHAHASH_OK;
+}
+
+void shahash_reset(shahash_ctx* ctx) {
+    if (ctx) ctx->hasher->reset();
+}
+
+void shahash_free(shahash_ctx* ctx) {
+    delete ctx;
+}
+
+int shahash_final(shahash_ctx* ctx, uint8_t* out, size_t out_size) {
+    if (!ctx || !out) return SHAHASH_ERROR_ARGUMENT;
+    size_t digestSize = ctx->hasher->digestSize();
+    if (out_size < digestSize) return SHAHASH_ERROR_ARGUMENT;
+    ctx->hasher->finalize(out);
+    ctx->hasher->reset();
+    return (int)digestSize;
+}
+
+int shahash_hash_many(const char* algorithm, const void* const* data, const size_t* lengths, size_t count,
+                      uint8_t* digests) {
+    const AlgorithmInfo* info = findAlgorithm(algorithm);
+    if (!info) return SHAHASH_ERROR_ALGORITHM;
+    if (count == 0) return SHAHASH_OK;
+    if (!data || !lengths || !digests) return SHAHASH_ERROR_ARGUMENT;
+    // Checked before any digest is written, so an error leaves digests untouched
+    for (size_t i = 0; i < count; ++i) {
+        if (!data[i] && lengths[i]) return SHAHASH_ERROR_ARGUMENT;
+    }
+
+    try {
+        // SHA-224 and SHA-256 share the multi-buffer kernels; only the IV and
+        // digest length differ
+        const uint32_t* iv = nullptr;
+        if (strcmp(info->name, "SHA-256") == 0) iv = Sha256Traits::IV;
+        if (strcmp(info->name, "SHA-224") == 0) iv = Sha224Traits::IV;
+        if (iv) {
+            vector<MessageView> messages(count);
+            for (size_t i = 0; i < count; ++i) messages[i] = {(const uint8_t*)data[i], lengths[i]};
+            size_t digestSize = iv == Sha256Traits::IV ? Sha256::DIGEST_SIZE : Sha224::DIGEST_SIZE;
+            sha256ManyDispatch().function()(iv, digestSize, messages.data(), count, digests);
+            return SHAHASH_OK;
+        }
+
+        // Other algorithms: one message after another, still one call per batch
+        unique_ptr<DynamicHasher> hasher = info->create();
+        size_t digestSize = info->digestSize;
+        for (size_t i = 0; i < count; ++i) {
+            hasher->reset();
+            hasher->update((const uint8_t*)data[i], lengths[i]);
+            hasher->finalize(digests + i * digestSize);
+        }
+        return SHAHASH_OK;
+    } catch (const bad_alloc&) {
+        return SHAHASH_ERROR_MEMORY;
+    }
+}
+
+}
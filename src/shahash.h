@@ -0,0 +1,90 @@
+/*
+ * libshahash: stable C ABI over the native hash kernels, for FFI consumers
+ * (Go, Rust, Java, ...). Built as bin/libshahash.so.1 (soname
+ * libshahash.so.1, with a bin/libshahash.so link; bin/shahash.dll on
+ * Windows) by build.sh / build.bat.
+ *
+ *   shahash_ctx* ctx = shahash_new("SHA-256");
+ *   shahash_update(ctx, data, length);
+ *   shahash_final(ctx, digest, sizeof(digest));
+ *   shahash_free(ctx);
+ *
+ *   shahash_hash_many("SHA-256", pointers, lengths, count, digests);
+ *
+ * Algorithms are named as in algorithms.json ("MD5", "SHA-1", "SHA-224",
+ * "SHA-256", "SHA-384", "SHA-512", "SHA-512/224", "SHA-512/256", "CRC-32").
+ * Existing functions never change signature or meaning; additions bump
+ * SHAHASH_ABI_VERSION. A context must not be used by two threads at once;
+ * everything else is thread-safe.
+ */
+#ifndef SHAHASH_H
+#define SHAHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #ifdef SHAHASH_BUILD
+        #define SHAHASH_API __declspec(dllexport)
+    #else
+        #define SHAHASH_API __declspec(dllimport)
+    #endif
+#else
+    #define SHAHASH_API __attribute__((visibility("default")))
+#endif
+
+#define SHAHASH_ABI_VERSION 1
+#define SHAHASH_MAX_DIGEST_SIZE 64
+
+/* Return codes; negative values are errors */
+#define SHAHASH_OK 0
+#define SHAHASH_ERROR_ALGORITHM -1   /* Unknown algorithm name */
+#define SHAHASH_ERROR_ARGUMENT -2    /* NULL pointer or output buffer too small */
+#define SHAHASH_ERROR_MEMORY -3
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct shahash_ctx shahash_ctx;
+
+/* SHAHASH_ABI_VERSION of the loaded library */
+SHAHASH_API uint32_t shahash_abi_version(void);
+
+/* Algorithm names by index, 0 <= index < shahash_algorithm_count(); NULL past the end */
+SHAHASH_API size_t shahash_algorithm_count(void);
+SHAHASH_API const char* shahash_algorithm_name(size_t index);
+
+/* Digest length in bytes; 0 for an unknown algorithm */
+SHAHASH_API size_t shahash_digest_size(const char* algorithm);
+
+/* Kernel variant in use (scalar, avx2, sha-ni, ...); NULL for an unknown algorithm */
+SHAHASH_API const char* shahash_backend(const char* algorithm);
+
+/* Incremental hashing. shahash_new returns NULL for an unknown algorithm;
+   shahash_update returns SHAHASH_OK, or SHAHASH_ERROR_ARGUMENT (nothing
+   hashed) for a NULL ctx, or NULL data with a nonzero length. */
+SHAHASH_API shahash_ctx* shahash_new(const char* algorithm);
+SHAHASH_API shahash_ctx* shahash_copy(const shahash_ctx* ctx);
+SHAHASH_API int shahash_update(shahash_ctx* ctx, const void* data, size_t length);
+SHAHASH_API void shahash_reset(shahash_ctx* ctx);
+SHAHASH_API void shahash_free(shahash_ctx* ctx);
+
+/* Write the digest of everything hashed so far to out and reset ctx for reuse.
+   Returns the digest size, or SHAHASH_ERROR_ARGUMENT if out_size is too small. */
+SHAHASH_API int shahash_final(shahash_ctx* ctx, uint8_t* out, size_t out_size);
+
+/* Hash count independent messages in one call: message i is data[i] with
+   lengths[i] bytes. Digests are written back to back to digests, which must
+   hold count * shahash_digest_size(algorithm) bytes. SHA-224/256 batches run
+   through the multi-buffer kernels. Returns SHAHASH_OK or an error code
+   (SHAHASH_ERROR_ARGUMENT if any data[i] is NULL with a nonzero length);
+   on error digests is left untouched. */
+SHAHASH_API int shahash_hash_many(const char* algorithm, const void* const* data, const size_t* lengths,
+                                  size_t count, uint8_t* digests);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
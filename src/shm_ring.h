@@ -0,0 +1,218 @@
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include "cancel_token.h"
+
+#ifdef __linux__
+    #include <unistd.h>
+    #include <poll.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+#endif
+
+// Shared-memory input ring: the alternative to stdin for a producer in
+// another process (app/shm_ring.py). The producer writes input straight into
+// a memfd mapping and the hasher reads it in place, saving the two copies
+// through a pipe. Passed as "--ring MEMFD:DATAFD:SPACEFD[:PID]" (inherited
+// fds, and the producer's process id).
+//
+// Layout: a 64-byte header ("HASHRNG1", then the capacity as a little-endian
+// uint64), then the data area used as a circular buffer. Positions are not
+// shared; two eventfd doorbells carry byte counts instead, and the syscalls
+// order the data writes before the doorbell on any CPU:
+//   data  producer -> hasher: bytes committed, plus RING_FLAG once at the end
+//   space hasher -> producer: bytes released (RING_FLAG: wake-up, no bytes)
+//
+// The producer is the process that started the hasher; PID names it (without
+// PID, the parent at open() is taken, which misses a producer that died
+// before then). Nothing closes an eventfd when the producer dies, so while
+// waiting the hasher also watches it (a pidfd, or a getppid() check every
+// RING_PARENT_CHECK_MS on kernels without one) and fails instead of waiting
+// forever, as a pipe reader would see EOF.
+
+constexpr size_t RING_HEADER_SIZE = 64;
+constexpr char RING_MAGIC[8] = {'H', 'A', 'S', 'H', 'R', 'N', 'G', '1'};
+constexpr uint64_t RING_FLAG = 1ULL << 62;
+constexpr int RING_PARENT_CHECK_MS = 1000;
+
+// Value of "--ring" in argv, or empty
+inline std::string ringOption(int argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--ring") return argv[i + 1];
+    }
+    return "";
+}
+
+class ShmRingReader {
+public:
+    ShmRingReader() {}
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    ~ShmRingReader() {
+#ifdef __linux__
+        if (mapping) munmap((void*)mapping, mappingSize);
+        for (int fd : {memoryFd, dataFd, spaceFd, parentFd}) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    bool active() const { return mapping != nullptr; }
+
+    // Attach to the ring described by a "--ring" value
+    bool open(const std::string& spec, std::string& error) {
+#ifdef __linux__
+        int fields = sscanf(spec.c_str(), "%d:%d:%d:%d", &memoryFd, &dataFd, &spaceFd, &parentPid);
+        if (fields < 3 || (fields == 4 && parentPid <= 0)) {
+            error = "Invalid --ring value (expected MEMFD:DATAFD:SPACEFD[:PID]): " + spec;
+            return false;
+        }
+        if (fields == 3) parentPid = getppid();
+        struct stat info;
+        if (fstat(memoryFd, &info) != 0 || (size_t)info.st_size <= RING_HEADER_SIZE) {
+            error = "Invalid ring memory fd";
+            return false;
+        }
+        void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, memoryFd, 0);
+        if (address == MAP_FAILED) {
+            error = std::string("Cannot map ring: ") + strerror(errno);
+            return false;
+        }
+        mapping = (const uint8_t*)address;
+        mappingSize = info.st_size;
+
+        uint64_t declared = 0;
+        for (int i = 0; i < 8; ++i) declared |= (uint64_t)mapping[8 + i] << (i * 8);
+        if (memcmp(mapping, RING_MAGIC, sizeof(RING_MAGIC)) != 0 || declared == 0 ||
+            declared > mappingSize - RING_HEADER_SIZE) {
+            error = "Ring header does not match";
+            return false;
+        }
+        capacity = declared;
+
+#ifdef SYS_pidfd_open
+        parentFd = (int)syscall(SYS_pidfd_open, parentPid, 0);
+        if (parentFd < 0 && errno == ESRCH) {
+            error = "Ring producer exited before the end of input";
+            return false;
+        }
+#endif
+        if (parentFd < 0 && getppid() != parentPid) {
+            error = "Ring producer exited before the end of input";
+            return false;
+        }
+        return true;
+#else
+        (void)spec;
+        error = "Shared-memory ring input needs Linux (memfd, eventfd)";
+        return false;
+#endif
+    }
+
+    // Next contiguous span of input, at most maxLength bytes (and at most a
+    // quarter of the ring, so the producer refills while it is hashed).
+    // length is 0 at the end of input, or when a wait is cancelled
+    // (cancel_token.h). The span stays valid until release().
+    bool next(size_t maxLength, const uint8_t*& data, size_t& length, std::string& error) {
+#ifdef __linux__
+        while (available == 0 && !ended) {
+            int ready = waitForDoorbell();
+            if (ready < 0 && errno == EINTR) {
+                if (!cancelRequested()) continue;
+                length = 0;
+                return true;
+            }
+            if (ready < 0) {
+                error = std::string("Ring doorbell wait failed: ") + strerror(errno);
+                return false;
+            }
+            if (ready == 0) {
+                error = "Ring producer exited before the end of input";
+                return false;
+            }
+            uint64_t value;
+            if (read(dataFd, &value, sizeof(value)) != sizeof(value)) {
+                if (errno == EINTR) continue;   // A cancel is seen by the next wait
+                error = std::string("Ring doorbell read failed: ") + strerror(errno);
+                return false;
+            }
+            // The producer sends the end flag once and never commits more
+            // than the free space; anything else would hash bytes it never wrote
+            if (value >= 2 * RING_FLAG) {
+                error = "Ring end of input signalled twice";
+                return false;
+            }
+            if (value >= RING_FLAG) {
+                ended = true;
+                value -= RING_FLAG;
+            }
+            if (value > capacity - available) {
+                error = "Ring producer committed more than the ring holds";
+                return false;
+            }
+            available += value;
+        }
+        size_t offset = consumed % capacity;
+        length = (size_t)std::min<uint64_t>(available, capacity - offset);
+        length = std::min(length, std::max<size_t>(1, std::min(maxLength, capacity / 4)));
+        data = mapping + RING_HEADER_SIZE + offset;
+        pending = length;
+        return true;
+#else
+        (void)maxLength; (void)data; (void)length;
+        error = "Shared-memory ring input needs Linux";
+        return false;
+#endif
+    }
+
+    // Give the span from next() back to the producer
+    void release() {
+#ifdef __linux__
+        if (pending == 0) return;
+        consumed += pending;
+        available -= pending;
+        uint64_t value = pending;
+        pending = 0;
+        while (write(spaceFd, &value, sizeof(value)) < 0 && errno == EINTR) {}
+#endif
+    }
+
+private:
+#ifdef __linux__
+    // 1 once the data doorbell is readable, 0 if the producer is gone,
+    // -1 with errno on failure (EINTR on a cancel signal)
+    int waitForDoorbell() {
+        pollfd fds[2] = {{dataFd, POLLIN, 0}, {parentFd, POLLIN, 0}};
+        while (true) {
+            int count = poll(fds, parentFd >= 0 ? 2 : 1, parentFd >= 0 ? -1 : RING_PARENT_CHECK_MS);
+            if (count < 0) return -1;
+            if (fds[0].revents & POLLIN) return 1;
+            if (parentFd >= 0 ? fds[1].revents != 0 : getppid() != parentPid) return 0;
+        }
+    }
+#endif
+
+    int memoryFd = -1;
+    int dataFd = -1;
+    int spaceFd = -1;
+    int parentFd = -1;        // pidfd of the producer, -1 without pidfd_open
+    int parentPid = 0;        // Producer
+    const uint8_t* mapping = nullptr;
+    size_t mappingSize = 0;
+    uint64_t capacity = 0;
+    uint64_t consumed = 0;    // Bytes released so far
+    uint64_t available = 0;   // Committed by the producer, not yet released
+    size_t pending = 0;       // Handed out by next(), not yet released
+    bool ended = false;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+// Span tracing in Chrome Trace Event format (load the file in Perfetto or
+// chrome://tracing). Each thread records complete ("X") events into its own
+// fixed-size ring: the owner is the only writer, so recording is two clock
+// reads and one release store, no locks. A thread registers its ring once,
+// on its first event. When a ring wraps, the oldest events are overwritten
+// and counted as dropped. writeChromeTrace() must run after the traced
+// threads have finished (or are quiescent).
+//
+// Tracing is off unless startTracing() was called; a disabled TraceSpan
+// costs one relaxed load.
+
+struct TraceEvent {
+    const char* name;     // Static strings only
+    const char* label;    // Optional detail, e.g. the algorithm; may be nullptr
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint64_t bytes;
+};
+
+class TraceRing {
+public:
+    static constexpr size_t CAPACITY = 1 << 15;   // 1.25 MB per traced thread
+
+    explicit TraceRing(uint32_t threadId) : threadId(threadId), events(new TraceEvent[CAPACITY]) {}
+
+    void push(const TraceEvent& event) {
+        uint64_t position = head.load(std::memory_order_relaxed);
+        events[position & (CAPACITY - 1)] = event;
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    uint32_t threadId;
+    std::string threadName;
+    std::atomic<uint64_t> head{0};
+    std::unique_ptr<TraceEvent[]> events;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point origin;
+    std::mutex registryMutex;   // Taken once per thread, on registration
+    std::vector<std::unique_ptr<TraceRing>> rings;
+};
+
+inline TraceState& traceState() {
+    static TraceState state;
+    return state;
+}
+
+inline bool tracingEnabled() {
+    return traceState().enabled.load(std::memory_order_relaxed);
+}
+
+inline void startTracing() {
+    TraceState& state = traceState();
+    state.origin = std::chrono::steady_clock::now();
+    state.enabled.store(true, std::memory_order_release);
+}
+
+inline uint64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - traceState().origin).count();
+}
+
+// This thread's ring, created and registered on first use
+inline TraceRing& threadTraceRing() {
+    thread_local TraceRing* ring = nullptr;
+    if (!ring) {
+        TraceState& state = traceState();
+        std::lock_guard<std::mutex> lock(state.registryMutex);
+        state.rings.emplace_back(new TraceRing((uint32_t)state.rings.size() + 1));
+        ring = state.rings.back().get();
+    }
+    return *ring;
+}
+
+// Name shown for this thread's track
+inline void traceThreadName(const std::string& name) {
+    if (tracingEnabled()) threadTraceRing().threadName = name;
+}
+
+inline void traceEvent(const char* name, const char* label, uint64_t startNs, uint64_t endNs, uint64_t bytes = 0) {
+    threadTraceRing().push({name, label, startNs, endNs - startNs, bytes});
+}
+
+// Records one span from construction to destruction
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* label = nullptr, uint64_t bytes = 0)
+        : name(name), label(label), bytes(bytes), active(tracingEnabled()) {
+        if (active) startNs = traceNow();
+    }
+
+    ~TraceSpan() {
+        if (active) traceEvent(name, label, startNs, traceNow(), bytes);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void setBytes(uint64_t count) { bytes = count; }
+
+private:
+    const char* name;
+    const char* label;
+    uint64_t bytes;
+    bool active;
+    uint64_t startNs = 0;
+};
+
+inline void writeJsonString(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') fputc('\\', out);
+        if ((unsigned char)*p >= 0x20) fputc(*p, out);
+    }
+    fputc('"', out);
+}
+
+// Write every recorded event; returns false if the file cannot be written
+inline bool writeChromeTrace(const std::string& path) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    TraceState& state = traceState();
+    std::lock_guard<std::mutex> lock(state.registryMutex);
+
+    uint64_t dropped = 0;
+    bool first = true;
+    fputs("{\"traceEvents\":[\n", out);
+    for (const auto& ring : state.rings) {
+        std::string threadName = ring->threadName.empty() ? "thread-" + std::to_string(ring->threadId) : ring->threadName;
+        fprintf(out, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":",
+                first ? "" : ",\n", ring->threadId);
+        writeJsonString(out, threadName.c_str());
+        fputs("}}", out);
+        first = false;
+
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = head > TraceRing::CAPACITY ? head - TraceRing::CAPACITY : 0;
+        dropped += begin;
+        for (uint64_t i = begin; i < head; ++i) {
+            const TraceEvent& event = ring->events[i & (TraceRing::CAPACITY - 1)];
+            fprintf(out, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"name\":", ring->threadId);
+            writeJsonString(out, event.name);
+            fprintf(out, ",\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"bytes\":%llu",
+                    event.startNs / 1000.0, event.durationNs / 1000.0, (unsigned long long)event.bytes);
+            if (event.label) {
+                fputs(",\"label\":", out);
+                writeJsonString(out, event.label);
+            }
+            fputs("}}", out);
+        }
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%llu}}\n",
+            (unsigned long long)dropped);
+    return fclose(out) == 0;
+}
+
+#endif
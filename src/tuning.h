@@ -0,0 +1,169 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cctype>
+#include <string>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include "cpu_dispatch.h"
+
+#ifndef _WIN32
+    #include <unistd.h>
+#endif
+
+// Per-host tuning profile written by `HashEngine --tune`.
+// Holds the fastest kernel variant per kernel family, the stdin/file buffer
+// size and the useful worker thread count measured on this machine. Every
+// executable (and app/hasher.py) loads it at startup; without one the
+// built-in defaults apply. The file is plain "key value" lines:
+//
+//   host build-42
+//   cpu sse4.1 avx2 avx512 sha-ni pclmul
+//   buffer_size 1048576
+//   threads 4
+//   kernel SHA-256 sha-ni
+//
+// A profile whose cpu line no longer matches the machine is ignored.
+
+constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+constexpr unsigned MAX_THREADS = 1024;
+
+struct TuningProfile {
+    bool loaded = false;
+    std::string host;
+    std::string cpu;
+    size_t bufferSize = 0;   // 0 when not tuned
+    int threads = 0;
+    std::map<std::string, std::string> kernels;   // Kernel family -> variant
+};
+
+// Host name restricted to file-name-safe characters.
+// Windows uses COMPUTERNAME so app/hasher.py derives the same file name.
+inline std::string tuningHostName() {
+    std::string name;
+#ifdef _WIN32
+    const char* computer = getenv("COMPUTERNAME");
+    if (computer) name = computer;
+#else
+    char buffer[256] = {0};
+    if (gethostname(buffer, sizeof(buffer) - 1) == 0) name = buffer;
+#endif
+    for (char& c : name) {
+        if (!isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') c = '_';
+    }
+    return name.empty() ? "localhost" : name;
+}
+
+// HASH_TUNE_FILE, else a per-host file in the user's cache directory
+inline std::string tuningProfilePath() {
+    const char* overridePath = getenv("HASH_TUNE_FILE");
+    if (overridePath && *overridePath) return overridePath;
+
+    std::filesystem::path directory;
+#ifdef _WIN32
+    const char* localAppData = getenv("LOCALAPPDATA");
+    directory = std::filesystem::path(localAppData ? localAppData : ".") / "HashingAlgorithm";
+#else
+    const char* cacheHome = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    if (cacheHome && *cacheHome) directory = cacheHome;
+    else directory = std::filesystem::path(home ? home : ".") / ".cache";
+    directory /= "hashing-algorithm";
+#endif
+    return (directory / ("profile-" + tuningHostName() + ".txt")).string();
+}
+
+// Plain decimal in [minimum, maximum]; false (value untouched) on a sign,
+// suffix, overflow or anything out of range
+inline bool parseDecimal(const std::string& text, unsigned long long minimum, unsigned long long maximum,
+                         unsigned long long& value) {
+    if (text.empty() || text.size() > 19 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    char* end = nullptr;
+    unsigned long long parsed = strtoull(text.c_str(), &end, 10);
+    if (*end != '\0' || parsed < minimum || parsed > maximum) return false;
+    value = parsed;
+    return true;
+}
+
+inline TuningProfile readTuningProfile(const std::string& path) {
+    TuningProfile profile;
+    std::ifstream in(path);
+    if (!in) return profile;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        std::string rest;
+        std::getline(fields >> std::ws, rest);
+
+        if (key == "host") profile.host = rest;
+        else if (key == "cpu") profile.cpu = rest;
+        else if (key == "buffer_size") profile.bufferSize = strtoull(rest.c_str(), nullptr, 10);
+        else if (key == "threads") {
+            unsigned long long threads;
+            if (parseDecimal(rest, 1, MAX_THREADS, threads)) profile.threads = (int)threads;   // Else untuned
+        }
+        else if (key == "kernel") {
+            size_t space = rest.rfind(' ');
+            if (space != std::string::npos) profile.kernels[rest.substr(0, space)] = rest.substr(space + 1);
+        }
+    }
+    profile.loaded = true;
+    return profile;
+}
+
+inline bool writeTuningProfile(const std::string& path, const TuningProfile& profile) {
+    std::error_code ignored;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ignored);
+
+    // Write then rename, so a concurrent reader never sees half a profile
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary);
+        if (!out) return false;
+        out << "# Hashing-Algorithm tuning profile, written by HashEngine --tune\n"
+            << "host " << profile.host << '\n'
+            << "cpu " << profile.cpu << '\n'
+            << "buffer_size " << profile.bufferSize << '\n'
+            << "threads " << profile.threads << '\n';
+        for (const auto& entry : profile.kernels) {
+            out << "kernel " << entry.first << ' ' << entry.second << '\n';
+        }
+        if (!out) return false;
+    }
+    std::filesystem::rename(temporary, path, ignored);
+    return !ignored;
+}
+
+// Profile for this process, loaded once; empty if missing or stale
+inline const TuningProfile& tuningProfile() {
+    static const TuningProfile profile = []() {
+        TuningProfile loaded = readTuningProfile(tuningProfilePath());
+        if (loaded.loaded && loaded.cpu != describeCpuFeatures()) return TuningProfile();
+        return loaded;
+    }();
+    return profile;
+}
+
+// Switch a dispatch table to the profiled variant; HASH_BACKEND still wins
+inline void applyTunedKernel(KernelSelector& kernels) {
+    if (getenv("HASH_BACKEND")) return;
+    auto entry = tuningProfile().kernels.find(kernels.name());
+    if (entry != tuningProfile().kernels.end()) kernels.select(entry->second.c_str());
+}
+
+inline size_t tunedBufferSize(size_t fallback = DEFAULT_BUFFER_SIZE) {
+    size_t tuned = tuningProfile().bufferSize;
+    return tuned > 0 ? tuned : fallback;
+}
+
+#endif